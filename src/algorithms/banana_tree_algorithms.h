@@ -1,6 +1,7 @@
 #pragma once
 
 #include "datastructure/banana_tree.h"
+#include "datastructure/persistence_diagram.h"
 #include "persistence_defs.h"
 
 namespace bananas {
@@ -59,4 +60,33 @@ void map_banana_dfs(const banana_tree<sign> &b, Visitor visitor) {
     }
 }
 
+// Call `visitor(birth, death, type)` for each persistent pair represented by the banana trees,
+// where `birth` and `death` are `const list_item*` and `type` is a `persistence_diagram::diagram_type`.
+// Visits the same pairs as `persistence_data_structure::extract_persistence_diagram`.
+// The relative pair born at the global maximum dies at the item of the down-tree's special root,
+// which has infinite order.
+template<typename Visitor>
+void map_persistent_pairs(const banana_tree<1> &up_tree, const banana_tree<-1> &down_tree, Visitor visitor) {
+    map_banana_dfs(up_tree, [&up_tree, &visitor](const up_tree_node* min_node,
+                                                 const up_tree_node* max_node,
+                                                 int, int) {
+        if (min_node == up_tree.get_left_hook() || min_node == up_tree.get_right_hook()) {
+            return;
+        }
+        if (max_node == up_tree.get_special_root()) {
+            visitor(min_node->get_item(), up_tree.get_global_max(), persistence_diagram::diagram_type::essential);
+        } else {
+            visitor(min_node->get_item(), max_node->get_item(), persistence_diagram::diagram_type::ordinary);
+        }
+    });
+    map_banana_dfs(down_tree, [&down_tree, &visitor](const down_tree_node* min_node,
+                                                     const down_tree_node* max_node,
+                                                     int, int) {
+        if (min_node == down_tree.get_left_hook() || min_node == down_tree.get_right_hook()) {
+            return;
+        }
+        visitor(min_node->get_item(), max_node->get_item(), persistence_diagram::diagram_type::relative);
+    });
+}
+
 } // End of namespace `bananas`
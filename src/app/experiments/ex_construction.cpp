@@ -9,6 +9,7 @@
 
 #include "app/experiments/utility/cli_options.h"
 #include "app/experiments/utility/data_generation.h"
+#include "datastructure/batch_construction.h"
 #include "datastructure/persistence_context.h"
 #include "persistence_defs.h"
 #include "utility/format_util.h"
@@ -79,6 +80,67 @@ void construct_experiment(size_t num_items,
     }
 }
 
+template<typename Generator>
+void batch_construct_experiment(size_t num_items,
+                                size_t num_series,
+                                size_t num_threads,
+                                size_t num_reps,
+                                bool interleaved,
+                                const typename Generator::parameters& generator_params) {
+    std::vector<function_value_type> series_values;
+    std::vector<function_value_type> values;
+    std::vector<function_value_type> interleaved_values;
+    std::vector<size_t> offsets;
+    diagram_batch diagrams;
+    csv_writer writer;
+
+    for (size_t rep = 0; rep < num_reps; ++ rep) {
+        std::cout << "> rep " << rep << "\n";
+        writer << std::make_pair("num_items", num_items)
+               << std::make_pair("num_series", num_series)
+               << std::make_pair("num_threads", num_threads)
+               << std::make_pair("interleaved", interleaved);
+
+        values.clear();
+        offsets.assign(1, 0);
+        for (size_t series = 0; series < num_series; ++series) {
+            series_values.clear();
+            Generator generator{generator_params};
+            generator(series_values, num_items);
+            if (series == 0) {
+                generator.write_parameters(writer);
+            }
+            values.insert(values.end(), series_values.begin(), series_values.end());
+            offsets.push_back(values.size());
+        }
+
+        if (interleaved) {
+            interleaved_values.resize(values.size());
+            for (size_t series = 0; series < num_series; ++series) {
+                for (size_t idx = 0; idx < num_items; ++idx) {
+                    interleaved_values[idx * num_series + series] = values[series * num_items + idx];
+                }
+            }
+        }
+
+        Timer<std::chrono::nanoseconds> timer;
+        timer.restart();
+        if (interleaved) {
+            construct_diagrams_interleaved({interleaved_values, num_series, num_items}, diagrams, num_threads);
+        } else {
+            construct_batch({values, offsets}, diagrams, num_threads);
+        }
+        auto construction_time = timer.elapsed();
+
+        const auto seconds = std::chrono::duration<double>(construction_time).count();
+        writer << std::make_pair("time", construction_time)
+               << std::make_pair("series_per_second", static_cast<double>(num_series) / seconds)
+               << std::make_pair("num_pairs", diagrams.pairs.size());
+
+        writer.write_to_stream_and_reset(std::cout);
+    }
+}
+
 int main(int argc, char** argv) {
 
     unsigned long seed = random_seed();
@@ -100,6 +162,20 @@ int main(int argc, char** argv) {
     add_persistence1d_flag(app, run_persistence1d);
     add_output_file_option(app, output_file_name);
 
+    size_t num_series = 10000;
+    size_t num_threads = 0;
+    bool interleaved = false;
+    auto* batch_app = app.add_subcommand("batch", "Construct the diagrams of many series of the same length on a thread pool");
+    batch_app->add_option("-N,--num-series",
+                          num_series,
+                          "Number of series per batch")
+        ->default_val(10000)
+        ->check(CLI::PositiveNumber);
+    add_num_threads_option(*batch_app, num_threads);
+    batch_app->add_flag("-l,--lanes",
+                        interleaved,
+                        "Compute only the diagrams, processing interleaved series in lockstep");
+
     CLI11_PARSE(app, argc, argv);
 
     if (num_item_limits[0] < 2 || num_item_limits[1] == 0 || num_item_limits[2] < num_item_limits[0]) {
@@ -125,6 +201,23 @@ int main(int argc, char** argv) {
 
     std::cout << "# Using generator " << gen_name << " with parameters " << gen_param_string << "\n";
 
+    if (app.got_subcommand(batch_app)) {
+        std::cout << "# Constructing batches of series.\n";
+        for (auto num_items = min_num_items; num_items <= max_num_items; num_items += step_num_items) {
+            if (gen_name == random_walk_generator<>::get_name()) {
+                batch_construct_experiment<random_walk_generator<decltype(rng)>>(num_items, num_series, num_threads, num_reps, interleaved, {rng, gen_param_string});
+            } else if (gen_name == gaussian_random_walk_generator<>::get_name()) {
+                batch_construct_experiment<gaussian_random_walk_generator<decltype(rng)>>(num_items, num_series, num_threads, num_reps, interleaved, {rng, gen_param_string});
+            } else if (gen_name == sum_quasi_periodic_generator<>::get_name()) {
+                batch_construct_experiment<sum_quasi_periodic_generator<decltype(rng)>>(num_items, num_series, num_threads, num_reps, interleaved, {rng, gen_param_string});
+            } else if (gen_name == modulating_quasi_periodic_generator<>::get_name()) {
+                batch_construct_experiment<modulating_quasi_periodic_generator<decltype(rng)>>(num_items, num_series, num_threads, num_reps, interleaved, {rng, gen_param_string});
+            }
+            std::cout << "--\n";
+        }
+        return 0;
+    }
+
     std::cout << "# Constructing a random walk.\n";
     for (auto num_items = min_num_items; num_items <= max_num_items; num_items += step_num_items) {
         if (gen_name == random_walk_generator<>::get_name()) {
@@ -18,10 +18,12 @@
 #include "utility/random.h"
 #include "utility/stats.h"
 #include "utility/timer.h"
+#include "utility/trace.h"
 
 using namespace bananas;
 
 std::ofstream output_file;
+bool concurrent_interchanges = false;
 
 struct random_internal_item_selector {
     template<typename RNG>
@@ -81,6 +83,7 @@ void local_maintenance(size_t num_items,
     Timer<std::chrono::nanoseconds> timer;
     csv_writer writer;
     multirow_csv_writer structure_writer;
+    latency_stats.reset();
 
     for (unsigned int rep = 0; rep < num_reps; ++rep) {
 
@@ -98,10 +101,12 @@ void local_maintenance(size_t num_items,
                    << std::make_pair("change_min", change_bounds.first)
                    << std::make_pair("change_max", change_bounds.second)
                    << std::make_pair("rep", rep)
-                   << std::make_pair("div", div);
+                   << std::make_pair("div", div)
+                   << std::make_pair("concurrent_interchanges", concurrent_interchanges);
             generator.write_parameters(writer);
 
             persistence_context context;
+            context.set_concurrent_interchanges(concurrent_interchanges);
             item_ptrs.clear();
             auto* the_interval = context.new_interval(values, {std::ref(item_ptrs)});
 
@@ -176,6 +181,16 @@ void local_maintenance(size_t num_items,
             context.change_value(the_interval, item_to_change, values[index]);
         }
     }
+
+    // Percentiles need many operations, so latencies are reported once for all repetitions.
+    // They include the construction of the intervals, their diagrams and the changes that restore the values.
+    if (get_latency_recording()) {
+        std::cout << "> latencies\n";
+        writer << std::make_pair("num_items", num_items)
+               << std::make_pair("num_reps", num_reps);
+        latency_stats.write_statistics<std::chrono::nanoseconds>(writer);
+        writer.write_to_stream_and_reset(std::cout);
+    }
 }
 
 template<typename Generator, typename RNG>
@@ -243,6 +258,9 @@ int main(int argc, char** argv) {
     bool run_persistence1d = false;
     std::string generator_args = "rw:0";
     std::string output_file_name;
+    long timer_sampling_period = 1;
+    bool record_latencies = false;
+    std::string trace_file_name;
 
     CLI::App app("Construction Experiments");
 
@@ -253,11 +271,17 @@ int main(int argc, char** argv) {
     add_persistence1d_flag(app, run_persistence1d);
     auto* gen_opt = add_gen_args_option(app, generator_args);
     add_output_file_option(app, output_file_name);
+    add_timer_sampling_option(app, timer_sampling_period);
+    add_latency_flag(app, record_latencies);
+    add_trace_option(app, trace_file_name);
     app.add_option("-m,--magnitude",
                    magnitude,
                    "Perform value changes in the interval [-m,m]")
         ->default_val(1)
         ->check(CLI::PositiveNumber);
+    app.add_flag("--concurrent-interchanges",
+                 concurrent_interchanges,
+                 "Perform the interchanges in the up-tree and the down-tree concurrently");
     app.add_option("-d,--divisions",
                    num_divisions,
                    "How many value changes to perform in [-m,m]")
@@ -271,6 +295,9 @@ int main(int argc, char** argv) {
 
     CLI11_PARSE(app, argc, argv);
 
+    time::set_sampling_period(timer_sampling_period);
+    set_latency_recording(record_latencies);
+
     if (num_item_limits[0] < 2 || num_item_limits[1] == 0 || num_item_limits[2] < num_item_limits[0]) {
         std::cerr << "num_items needs to be of the form min number_of_steps max, with min >= 2, number_of_steps >= 1 and max >= min.\n";
         std::cerr << app.help() << std::endl;
@@ -358,6 +385,11 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (trace_file_name != "") {
+        std::ofstream trace_file{trace_file_name};
+        trace::write_chrome_trace(trace_file);
+    }
+
     return 0;
 
 }
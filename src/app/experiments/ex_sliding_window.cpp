@@ -14,6 +14,7 @@
 #include "utility/random.h"
 #include "utility/stats.h"
 #include "utility/timer.h"
+#include "utility/trace.h"
 
 std::ofstream output_file;
 
@@ -33,6 +34,9 @@ int main(int argc, char** argv) {
     bool run_persistence1d = false;
     std::string generator_args = "rw:0";
     std::string output_file_name;
+    long timer_sampling_period = 1;
+    bool record_latencies = false;
+    std::string trace_file_name;
 
     CLI::App app("Sliding Window Experiments");
 
@@ -41,6 +45,9 @@ int main(int argc, char** argv) {
     add_persistence1d_flag(app, run_persistence1d);
     add_gen_args_option(app, generator_args);
     add_output_file_option(app, output_file_name);
+    add_timer_sampling_option(app, timer_sampling_period);
+    add_latency_flag(app, record_latencies);
+    add_trace_option(app, trace_file_name);
     app.add_option("-n,--num_slides",
                    num_slides,
                    "Number of slides")
@@ -55,6 +62,9 @@ int main(int argc, char** argv) {
 
     CLI11_PARSE(app, argc, argv);
 
+    bananas::time::set_sampling_period(timer_sampling_period);
+    bananas::set_latency_recording(record_latencies);
+
     const auto min_window_size = window_size_limits[0];
     const auto step_window_size = window_size_limits[1];
     const auto max_window_size = window_size_limits[2];
@@ -103,5 +113,10 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (trace_file_name != "") {
+        std::ofstream trace_file{trace_file_name};
+        bananas::trace::write_chrome_trace(trace_file);
+    }
+
     return 0;
 }
@@ -3,13 +3,18 @@
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "CLI11.hpp"
 
 #include "app/experiments/utility/cli_options.h"
+#include "datastructure/ingest_pipeline.h"
+#include "datastructure/multi_window_context.h"
 #include "datastructure/persistence_context.h"
 #include "datastructure/persistence_diagram.h"
+#include "datastructure/sharded_persistence_context.h"
 #include "gudhi/Persistence_on_a_line.h"
 #include "persistence_defs.h"
 #include "utility/errors.h"
@@ -17,6 +22,7 @@
 #include "utility/random.h"
 #include "utility/stats.h"
 #include "utility/timer.h"
+#include "utility/trace.h"
 
 using namespace bananas;
 
@@ -93,8 +99,113 @@ void structure_experiment(size_t num_reps, bool run_gudhi, rng_type& rng, functi
 }
 
 
+// Slide windows of all sizes in `window_sizes` over the time series given on stdin,
+// keeping all windows in one `multi_window_context`.
+void window_experiment(const std::vector<size_t> &window_sizes) {
+    std::vector<function_value_type> values = read_value_from_stream(std::cin);
+
+    std::string window_sizes_string;
+    for (auto size: window_sizes) {
+        window_sizes_string += (window_sizes_string.empty() ? "" : ":") + std::to_string(size);
+    }
+
+    csv_writer writer;
+    Timer<std::chrono::nanoseconds> timer;
+
+    persistence_stats.reset();
+    dictionary_stats.reset();
+    latency_stats.reset();
+
+    multi_window_context windows{window_sizes};
+    timer.restart();
+    for (auto value: values) {
+        windows.push_value(value);
+    }
+    auto ingest_time = timer.elapsed();
+
+    std::vector<persistence_diagram> diagrams;
+    timer.restart();
+    windows.compute_persistence_diagrams(diagrams);
+    auto diagram_time = timer.elapsed();
+
+    writer << std::make_pair("num_items", values.size())
+           << std::make_pair("window_sizes", window_sizes_string)
+           << std::make_pair("time", ingest_time)
+           << std::make_pair("time_diagrams", diagram_time);
+    persistence_stats.write_statistics(writer);
+    dictionary_stats.write_statistics(writer);
+    latency_stats.write_statistics(writer);
+    windows.print_memory_stats(writer);
+    writer.write_to_stream_and_reset(std::cout);
+}
 
+// Append the time series given on stdin to an interval while parsing it on another thread.
+void stream_experiment(const ingest_pipeline::options &pipeline_options) {
+    csv_writer writer;
+    Timer<std::chrono::nanoseconds> timer;
+
+    persistence_context context;
+    ingest_pipeline pipeline{context, pipeline_options};
+    timer.restart();
+    auto* const the_interval = pipeline.ingest(std::cin);
+    auto ingest_time = timer.elapsed();
 
+    writer << std::make_pair("num_items", pipeline.get_maintenance_statistics().num_values)
+           << std::make_pair("chunk_size", pipeline_options.chunk_size)
+           << std::make_pair("chunks_in_flight", pipeline_options.max_chunks_in_flight)
+           << std::make_pair("time", ingest_time);
+    pipeline.write_statistics(writer);
+    context.print_memory_stats(writer);
+    if (the_interval != nullptr) {
+        writer << std::make_pair("global_max_value", context.get_global_max_value(the_interval))
+               << std::make_pair("global_min_value", context.get_global_min_value(the_interval));
+    }
+    writer.write_to_stream_and_reset(std::cout);
+}
+
+// Distribute the time series given on stdin over `num_series` series, appending value `i` to series `i % num_series`,
+// and append them through a `sharded_persistence_context` with each number of threads in `thread_counts`.
+void shard_experiment(const std::vector<size_t> &thread_counts, size_t num_series, size_t num_reps) {
+    std::vector<function_value_type> values = read_value_from_stream(std::cin);
+
+    csv_writer writer;
+    Timer<std::chrono::nanoseconds> timer;
+
+    for (size_t rep = 0; rep < num_reps; ++rep) {
+        std::cout << "> rep " << rep << "\n";
+        for (auto num_threads: thread_counts) {
+            persistence_stats.reset();
+            dictionary_stats.reset();
+
+            size_t num_shards;
+            size_t num_steals;
+            timer.restart();
+            {
+                sharded_persistence_context context{num_threads};
+                for (size_t idx = 0; idx < values.size(); ++idx) {
+                    context.append(idx % num_series, values[idx]);
+                }
+                context.flush();
+                num_shards = context.get_num_shards();
+                num_steals = context.get_num_steals();
+            }
+            const auto ingest_time = timer.elapsed();
+            const auto seconds = std::chrono::duration<double>(ingest_time).count();
+
+            writer << std::make_pair("num_items", values.size())
+                   << std::make_pair("num_series", num_series)
+                   << std::make_pair("num_threads", num_threads)
+                   << std::make_pair("num_shards", num_shards)
+                   << std::make_pair("rep", rep)
+                   << std::make_pair("time", ingest_time)
+                   << std::make_pair("throughput", static_cast<double>(values.size()) / seconds)
+                   << std::make_pair("steals", num_steals);
+            persistence_stats.write_statistics(writer);
+            dictionary_stats.write_statistics(writer);
+            writer.write_to_stream_and_reset(std::cout);
+        }
+    }
+}
 
 int main(int argc, char** argv) {
 
@@ -103,6 +214,9 @@ int main(int argc, char** argv) {
     bool run_gudhi = false;
     std::string output_file_name;
     function_value_type noise_amount = 1e-2;
+    long timer_sampling_period = 1;
+    bool record_latencies = false;
+    std::string trace_file_name;
 
     CLI::App app("Experiments on Time Series");
 
@@ -110,15 +224,47 @@ int main(int argc, char** argv) {
     add_gudhi_flag(app, run_gudhi);
     add_output_file_option(app, output_file_name);
     add_seed_option(app, seed);
+    add_timer_sampling_option(app, timer_sampling_period);
+    add_latency_flag(app, record_latencies);
+    add_trace_option(app, trace_file_name);
     app.add_option("-r,--random-range",
                    noise_amount,
                    "Scale of noise relative to (max-min); default is 1e-5.");
     
     auto* construct_app = app.add_subcommand("construct", "Construct banana trees.");
 
+    std::vector<size_t> window_sizes;
+    auto* windows_app = app.add_subcommand("windows", "Slide windows of several sizes over the time series at once.");
+    windows_app->add_option("-w,--window", window_sizes, "Size of a window; may be given multiple times")
+        ->required()
+        ->check(CLI::Range(size_t{2}, std::numeric_limits<size_t>::max()));
+
+    ingest_pipeline::options pipeline_options;
+    auto* stream_app = app.add_subcommand("stream", "Append the time series to a banana tree while parsing it on another thread.");
+    stream_app->add_option("-c,--chunk-size", pipeline_options.chunk_size, "Number of values handed over at once")
+        ->default_val(pipeline_options.chunk_size)
+        ->check(CLI::PositiveNumber);
+    stream_app->add_option("-f,--chunks-in-flight",
+                           pipeline_options.max_chunks_in_flight,
+                           "Number of parsed chunks after which the parser waits for the banana trees to catch up")
+        ->default_val(pipeline_options.max_chunks_in_flight)
+        ->check(CLI::Range(size_t{1}, ingest_pipeline::max_queue_size));
+
+    std::vector<size_t> thread_counts{1};
+    size_t num_series = 64;
+    auto* shards_app = app.add_subcommand("shards", "Append the time series, split into many series, to a sharded context.");
+    shards_app->add_option("-t,--threads", thread_counts, "Number of worker threads; may be given multiple times")
+        ->check(CLI::PositiveNumber);
+    shards_app->add_option("--series", num_series, "Number of series that the values are distributed over")
+        ->default_val(num_series)
+        ->check(CLI::PositiveNumber);
+
     app.require_subcommand();
 
     CLI11_PARSE(app, argc, argv);
+
+    time::set_sampling_period(timer_sampling_period);
+    set_latency_recording(record_latencies);
     
     if (output_file_name != "") {
         output_file.open(output_file_name);
@@ -135,6 +281,28 @@ int main(int argc, char** argv) {
         structure_experiment(num_reps, run_gudhi, rng, noise_amount);
         std::cout << "--\n";
     }
+    if (app.got_subcommand(windows_app)) {
+        std::cout << "# Sliding multiple windows.\n";
+        window_experiment(window_sizes);
+        std::cout << "--\n";
+    }
+
+    if (app.got_subcommand(stream_app)) {
+        std::cout << "# Streaming a time series.\n";
+        stream_experiment(pipeline_options);
+        std::cout << "--\n";
+    }
+
+    if (app.got_subcommand(shards_app)) {
+        std::cout << "# Appending to many series on a sharded context.\n";
+        shard_experiment(thread_counts, num_series, num_reps);
+        std::cout << "--\n";
+    }
+
+    if (trace_file_name != "") {
+        std::ofstream trace_file{trace_file_name};
+        trace::write_chrome_trace(trace_file);
+    }
 
     return 0;
 }
@@ -19,10 +19,12 @@
 #include "utility/random.h"
 #include "utility/stats.h"
 #include "utility/timer.h"
+#include "utility/trace.h"
 
 using namespace bananas;
 
 std::ofstream output_file;
+bool parallel_cuts = false;
 
 template<typename Generator>
 void cut_experiment(size_t num_items,
@@ -35,18 +37,19 @@ void cut_experiment(size_t num_items,
 
     std::vector<function_value_type> values;
     using iter_t = std::vector<function_value_type>::iterator;
-    std::vector<list_item*> item_ptrs;
 
     Timer<std::chrono::nanoseconds> timer;
     csv_writer writer;
     multirow_csv_writer structure_writer;
+    latency_stats.reset();
 
     for (unsigned int rep = 0; rep < num_reps; ++rep) {
         std::cout << "> rep " << rep << "\n";
 
         writer << std::make_pair("num_items", num_items)
                << std::make_pair("cut_fraction", cut_fraction)
-               << std::make_pair("cut_index", cut_index);
+               << std::make_pair("cut_index", cut_index)
+               << std::make_pair("parallel_cuts", parallel_cuts);
 
         values.clear();
         Generator generator{gen_params};
@@ -56,8 +59,8 @@ void cut_experiment(size_t num_items,
         persistence_diagram pd_before, pd_after;
 
         persistence_context context;
-        item_ptrs.clear();
-        auto* const the_interval = context.new_interval(values, {std::ref(item_ptrs)});
+        context.set_parallel_cuts(parallel_cuts);
+        auto* const the_interval = context.new_interval(values);
 
         const auto global_max_order = context.get_global_max_order(the_interval);
         const auto global_min_order = context.get_global_min_order(the_interval);
@@ -74,10 +77,13 @@ void cut_experiment(size_t num_items,
             structure_writer.write_to_stream_and_reset(output_file, rep == 0);
         }
 
+        // Items are at orders 0, 1, 2, ..., so the item to cut at has order `cut_index`.
+        auto* const cut_item = context.find_item(the_interval, static_cast<interval_order_type>(cut_index));
+
         persistence_stats.reset();
         dictionary_stats.reset();
         timer.restart();
-        context.cut_interval(the_interval, item_ptrs[cut_index]);
+        context.cut_interval(the_interval, cut_item);
         const auto cut_time = timer.elapsed();
 
         context.compute_persistence_diagram(pd_after);
@@ -133,6 +139,16 @@ void cut_experiment(size_t num_items,
         dictionary_stats.write_statistics<std::chrono::nanoseconds>(writer);
         writer.write_to_stream_and_reset(std::cout);
     }
+
+    // One operation per repetition, so latencies are reported for all repetitions together.
+    if (get_latency_recording()) {
+        std::cout << "> latencies\n";
+        writer << std::make_pair("num_items", num_items)
+               << std::make_pair("cut_fraction", cut_fraction)
+               << std::make_pair("num_reps", num_reps);
+        latency_stats.write_statistics<std::chrono::nanoseconds>(writer);
+        writer.write_to_stream_and_reset(std::cout);
+    }
 }
 
 template<typename Generator>
@@ -146,11 +162,11 @@ void glue_experiment(size_t num_items,
 
     std::vector<function_value_type> all_values;
     std::vector<function_value_type> values_left, values_right;
-    std::vector<list_item*> item_ptrs_left, item_ptrs_right;
 
     Timer<std::chrono::nanoseconds> timer;
     csv_writer writer;
     multirow_csv_writer structure_writer;
+    latency_stats.reset();
 
     for (unsigned int rep = 0; rep < num_reps; ++rep) {
         std::cout << "> rep " << rep << "\n";
@@ -170,10 +186,8 @@ void glue_experiment(size_t num_items,
         persistence_diagram pd_before, pd_after;
 
         persistence_context context;
-        item_ptrs_left.clear();
-        item_ptrs_right.clear();
-        auto* const the_left_interval = context.new_interval(values_left, {std::ref(item_ptrs_left)});
-        auto* const the_right_interval = context.new_interval(values_right, {std::ref(item_ptrs_right)}, values_left.size());
+        auto* const the_left_interval = context.new_interval(values_left);
+        auto* const the_right_interval = context.new_interval(values_right, std::nullopt, values_left.size());
 
         context.compute_persistence_diagram(pd_before);
 
@@ -233,6 +247,16 @@ void glue_experiment(size_t num_items,
         dictionary_stats.write_statistics<std::chrono::nanoseconds>(writer);
         writer.write_to_stream_and_reset(std::cout);
     }
+
+    // One operation per repetition, so latencies are reported for all repetitions together.
+    if (get_latency_recording()) {
+        std::cout << "> latencies\n";
+        writer << std::make_pair("num_items", num_items)
+               << std::make_pair("cut_fraction", cut_fraction)
+               << std::make_pair("num_reps", num_reps);
+        latency_stats.write_statistics<std::chrono::nanoseconds>(writer);
+        writer.write_to_stream_and_reset(std::cout);
+    }
 }
 
 
@@ -247,6 +271,9 @@ int main(int argc, char** argv) {
     bool run_persistence1d = false;
     std::string generator_args = "rw:0";
     std::string output_file_name;
+    long timer_sampling_period = 1;
+    bool record_latencies = false;
+    std::string trace_file_name;
     
     CLI::App app("Topological Maintenance Experiments");
 
@@ -257,10 +284,16 @@ int main(int argc, char** argv) {
     add_persistence1d_flag(app, run_persistence1d);
     auto* gen_opt = add_gen_args_option(app, generator_args);
     add_output_file_option(app, output_file_name);
+    add_timer_sampling_option(app, timer_sampling_period);
+    add_latency_flag(app, record_latencies);
+    add_trace_option(app, trace_file_name);
     app.add_option("-c,--cut_fraction",
                    cut_fraction,
                    "Where to cut the interval.")
        ->check(open_interval(0.0, 1.0));
+    app.add_flag("--parallel-cuts",
+                 parallel_cuts,
+                 "Cut the up-tree and the down-tree concurrently");
 
     auto* cut_app = app.add_subcommand("cut", "Cutting intervals");
     auto* glue_app = app.add_subcommand("glue", "Gluing intervals");
@@ -271,6 +304,9 @@ int main(int argc, char** argv) {
 
     CLI11_PARSE(app, argc, argv);
 
+    time::set_sampling_period(timer_sampling_period);
+    set_latency_recording(record_latencies);
+
     const auto min_num_items = num_item_limits[0];
     const auto step_num_items = num_item_limits[1];
     const auto max_num_items = num_item_limits[2];
@@ -368,5 +404,10 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (trace_file_name != "") {
+        std::ofstream trace_file{trace_file_name};
+        trace::write_chrome_trace(trace_file);
+    }
+
     return 0;
 }
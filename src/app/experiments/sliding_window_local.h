@@ -64,6 +64,7 @@ inline void sliding_window(size_t num_slides,
 
     persistence_stats.reset();
     dictionary_stats.reset();
+    latency_stats.reset();
 
     for (size_t slide = 1; slide <= num_slides; ++slide) {
         std::cout << "> rep " << slide << "\n";
@@ -131,4 +132,14 @@ inline void sliding_window(size_t num_slides,
         writer.write_to_stream_and_reset(std::cout);
     }
 
+    if (get_latency_recording()) {
+        std::cout << "> latencies\n";
+        writer << std::make_pair("window_size", window_size)
+               << std::make_pair("step_size", step_size)
+               << std::make_pair("method", "local")
+               << std::make_pair("num_slides", num_slides);
+        latency_stats.write_statistics(writer);
+        writer.write_to_stream_and_reset(std::cout);
+    }
+
 }
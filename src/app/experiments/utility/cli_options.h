@@ -3,6 +3,7 @@
 #include <array>
 #include <cstddef>
 #include <limits>
+#include <string>
 
 #include "CLI11.hpp"
 
@@ -20,6 +21,33 @@ inline CLI::Option* add_num_reps_option(CLI::App& app, size_t& num_reps) {
         ->check(CLI::PositiveNumber);
 }
 
+inline CLI::Option* add_num_threads_option(CLI::App& app, size_t& num_threads) {
+    return app.add_option("-t,--threads",
+                          num_threads,
+                          "Number of threads; 0 uses one thread per core")
+        ->default_val(0);
+}
+
+inline CLI::Option* add_timer_sampling_option(CLI::App& app, long& sampling_period) {
+    return app.add_option("--sample-timers",
+                          sampling_period,
+                          "Time one in this many phases and scale the reported times accordingly")
+        ->default_val(1)
+        ->check(CLI::PositiveNumber);
+}
+
+inline CLI::Option* add_latency_flag(CLI::App& app, bool& record_latencies) {
+    return app.add_flag("--latencies",
+                        record_latencies,
+                        "Record the latencies of the operations and report their percentiles once per run");
+}
+
+inline CLI::Option* add_trace_option(CLI::App& app, std::string& trace_file) {
+    return app.add_option("--trace",
+                          trace_file,
+                          "Output file for a Chrome trace of the operations; requires a build with tracing");
+}
+
 inline CLI::Option* add_num_items_option(CLI::App& app, size_t& num_items) {
     return app.add_option("num_items",
                           num_items,
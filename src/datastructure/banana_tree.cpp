@@ -114,8 +114,9 @@ void banana_tree_node<sign>::set_mid_or_down(self* node, bool set_mid) {
 //
 
 SIGN_TEMPLATE
-banana_tree<sign>::banana_tree(node_pool_type &node_pool) :
+banana_tree<sign>::banana_tree(node_pool_type &node_pool, scratch_space* scratch) :
         node_pool(node_pool),
+        scratch(scratch),
         left_hook_item(0),
         right_hook_item(0),
         special_root_item(std::numeric_limits<interval_order_type>::infinity(),
@@ -124,8 +125,10 @@ banana_tree<sign>::banana_tree(node_pool_type &node_pool) :
 SIGN_TEMPLATE
 banana_tree<sign>::banana_tree(node_pool_type &node_pool,
                          list_item* left_endpoint,
-                         list_item* right_endpoint) :
+                         list_item* right_endpoint,
+                         scratch_space* scratch) :
         node_pool(node_pool),
+        scratch(scratch),
         left_hook_item(0),
         right_hook_item(0),
         special_root_item(std::numeric_limits<interval_order_type>::infinity(),
@@ -137,6 +140,7 @@ banana_tree<sign>::banana_tree(node_pool_type &node_pool,
 
 SIGN_TEMPLATE
 banana_tree<sign>::banana_tree(banana_tree &&other) : node_pool(other.node_pool),
+                                                      scratch(other.scratch),
                                                       left_hook_item(std::move(other.left_hook_item)),
                                                       right_hook_item(std::move(other.right_hook_item)),
                                                       special_root_item(std::move(other.special_root_item)),
@@ -153,6 +157,11 @@ banana_tree<sign>::banana_tree(banana_tree &&other) : node_pool(other.node_pool)
 
 SIGN_TEMPLATE
 banana_tree<sign>::~banana_tree() {
+    clear();
+}
+
+SIGN_TEMPLATE
+void banana_tree<sign>::clear() {
     if (get_special_root() == nullptr) {
         // No speical root means no banana tree to destroy
         return;
@@ -172,6 +181,7 @@ banana_tree<sign>::~banana_tree() {
     }
 //    // The special root is not visited by the string iterator...
 //    free_node(&special_root_item);
+    global_max = nullptr;
 }
 
 SIGN_TEMPLATE
@@ -282,22 +292,33 @@ namespace bananas {
 
 persistence_data_structure::persistence_data_structure(
             recycling_object_pool<up_tree_node> &up_tree_node_pool,
-            recycling_object_pool<down_tree_node> &down_tree_node_pool) :
-        up_tree(up_tree_node_pool),
-        down_tree(down_tree_node_pool) {}
+            recycling_object_pool<down_tree_node> &down_tree_node_pool,
+            persistence_scratch_space* scratch) :
+        up_tree(up_tree_node_pool, scratch != nullptr ? &scratch->up_tree_scratch : nullptr),
+        down_tree(down_tree_node_pool, scratch != nullptr ? &scratch->down_tree_scratch : nullptr),
+        scratch(scratch) {}
 
 persistence_data_structure::persistence_data_structure(recycling_object_pool<up_tree_node> &up_tree_node_pool,
                                                        recycling_object_pool<down_tree_node> &down_tree_node_pool,
                                                        list_item* left_endpoint,
-                                                       list_item* right_endpoint) :
-        up_tree(up_tree_node_pool, left_endpoint, right_endpoint),
-        down_tree(down_tree_node_pool, left_endpoint, right_endpoint) {}
+                                                       list_item* right_endpoint,
+                                                       persistence_scratch_space* scratch) :
+        up_tree(up_tree_node_pool, left_endpoint, right_endpoint,
+                scratch != nullptr ? &scratch->up_tree_scratch : nullptr),
+        down_tree(down_tree_node_pool, left_endpoint, right_endpoint,
+                  scratch != nullptr ? &scratch->down_tree_scratch : nullptr),
+        scratch(scratch) {}
 
 void persistence_data_structure::construct(list_item* left_endpoint, list_item* right_endpoint) {
     up_tree.construct(left_endpoint, right_endpoint);
     down_tree.construct(left_endpoint, right_endpoint);
 }
 
+void persistence_data_structure::clear() {
+    up_tree.clear();
+    down_tree.clear();
+}
+
 void persistence_data_structure::extract_persistence_diagram(persistence_diagram &dgm) const {
     using persistence_diagram::diagram_type::essential;
     using persistence_diagram::diagram_type::ordinary;
@@ -104,6 +104,15 @@ namespace bananas {
             // Checks whether no more bananas can be popped of the stack.
             bool empty() const;
 
+            // Remove all bananas, but keep the memory of the stack for reuse.
+            void clear();
+            // Replace the bananas of this stack by those of `other` and reset the `top` pointer.
+            void assign(const banana_stack &other);
+            // Returns the number of bananas on the stack, including those that have been popped but not actually popped.
+            size_t size() const;
+            // Returns the number of bananas that fit onto the stack without allocating memory.
+            size_t capacity() const;
+
         private:
             std::vector<banana_type> stack;
             std::vector<banana_type>::reverse_iterator top_iter;
@@ -364,13 +373,18 @@ namespace bananas {
             class walk_iterator_pair;
             class string_iterator_pair;
 
+            struct scratch_space;
+
             // Construct an empty banana tree using `node_pool` to allocate nodes.
-            banana_tree(node_pool_type &node_pool);
+            // If `scratch` is given, cuts and constructions use it instead of allocating temporary memory.
+            banana_tree(node_pool_type &node_pool, scratch_space* scratch = nullptr);
             // Construct a banana tree for the interval between `left_endpoint` and `right_endpoint`
             // using `node_pool` to allocate nodes.
+            // If `scratch` is given, cuts and constructions use it instead of allocating temporary memory.
             banana_tree(node_pool_type &node_pool,
                         list_item* left_endpoint,
-                        list_item* right_endpoint);
+                        list_item* right_endpoint,
+                        scratch_space* scratch = nullptr);
 
             banana_tree(const banana_tree &other) = delete;
 
@@ -385,6 +399,8 @@ namespace bananas {
 
             // Construct the banana tree for the interval between `left_endpoint` and `right_endpoint`.
             void construct(list_item* left_endpoint, list_item* right_endpoint);
+            // Free all nodes of this tree, which leaves an empty tree that can be constructed anew.
+            void clear();
 
             //
             // Local maintenance operations
@@ -469,6 +485,7 @@ namespace bananas {
             // then `other_tree` will contain the items to the right of `cut_item`,
             // otherwise it will contain the items to the left of `cut_item`.
             // The items `left_of_cut` and `right_of_cut` are the items immediately to the left and right of `cut_item`, respectively.
+            // Bananas of the opposite tree that are not bananas of this tree must not be on `L_inv_stack` or `R_inv_stack`.
             // Returns `true` if the tree is cut in the left spine, false otherwise.
             bool cut(list_item& cut_item,
                      list_item& left_of_cut,
@@ -480,6 +497,34 @@ namespace bananas {
                      internal::banana_stack<-sign> &L_inv_stack,
                      internal::banana_stack<-sign> &R_inv_stack);
 
+            // State of a cut between `begin_cut` and `finish_cut`.
+            struct cut_state {
+                bool cuts_left;
+                node_ptr_type dummy_node;
+                // The inverse stack that `begin_cut` added a banana to, if any
+                std::optional<internal::stack_variant> modified_stack;
+            };
+            // `cut` split into two phases. `begin_cut` runs the main loop of the cut,
+            // which is the only part that reads `L_inv_stack` and `R_inv_stack`;
+            // `finish_cut` updates the hooks, which changes values and orders of this tree's hook items.
+            // Thus, the two trees of a `persistence_data_structure` may run `begin_cut` concurrently,
+            // given their own copies of the inverse stacks,
+            // as long as both are done before either calls `finish_cut`.
+            // The inverse stacks passed to `begin_cut` have to stay alive until `finish_cut` returns.
+            cut_state begin_cut(list_item& cut_item,
+                                list_item& left_of_cut,
+                                list_item& right_of_cut,
+                                tree_type &other_tree,
+                                internal::banana_stack<sign> &L_stack,
+                                internal::banana_stack<sign> &M_stack,
+                                internal::banana_stack<sign> &R_stack,
+                                internal::banana_stack<-sign> &L_inv_stack,
+                                internal::banana_stack<-sign> &R_inv_stack);
+            void finish_cut(cut_state &state,
+                            list_item& left_of_cut,
+                            list_item& right_of_cut,
+                            tree_type &other_tree);
+
             //
             // 
             //
@@ -515,7 +560,7 @@ namespace bananas {
             //
 
             // Swap trees `tree_a` and `tree_b` by swapping the nodes associated with special roots and the hooks,
-            // and swapping values/orders of special roots and hooks.
+            // and swapping values/orders of special roots and hooks, global maxima and endpoints.
             // If `tree_a` and `tree_b` use different node pools, then there will be horrific memory issues,
             // so this is forbidden.
             friend void swap(banana_tree& tree_a, banana_tree& tree_b) {
@@ -527,6 +572,7 @@ namespace bananas {
                 tree_a.special_root_item.swap_order_and_value(tree_b.special_root_item);
                 tree_a.left_hook_item.swap_order_and_value(tree_b.left_hook_item);
                 tree_a.right_hook_item.swap_order_and_value(tree_b.right_hook_item);
+                std::swap(tree_a.global_max, tree_b.global_max);
                 std::swap(tree_a.left_endpoint, tree_b.left_endpoint);
                 std::swap(tree_a.right_endpoint, tree_b.right_endpoint);
             }
@@ -534,6 +580,8 @@ namespace bananas {
         private:
             // A memory pool from which to allocated nodes
             node_pool_type &node_pool;
+            // Scratch space shared with other trees, or `nullptr` if this tree allocates temporary memory itself
+            scratch_space* scratch;
 
             // An item for the hook on the left end of the interval
             // This is assigned a value, but may not be represented by a node.
@@ -682,6 +730,12 @@ namespace bananas {
             // becomes the special root of the tree rooted at `other_special_root`.
             void ensure_glued_tree_is_this(node_ptr_type other_special_root, node_ptr_type dummy_node);
 
+            // Helper function for `glue_to_right`.
+            // Relabels the tops of the spines of the glued tree, where `last_left_item` is the rightmost item of the left tree.
+            // Walks down each spine until it meets a node of the outer spine of the left or right tree, respectively,
+            // below which the spine is unchanged.
+            void relabel_glued_spines(const list_item &last_left_item);
+
             // Helper function for `cut` that executes the main loop of the cutting algorithm.
             // For details on arguments see `cut()`.
             // `dummy_node` points to the dummy node defined in the "other tree".
@@ -792,6 +846,64 @@ namespace bananas {
             // Set the labels of nodes on splines appropriately.
             void initialize_spline_labels();
 
+        public:
+            // Temporary memory used by cuts and constructions,
+            // which is kept between operations such that it doesn't have to be allocated again.
+            // Trees that share scratch space must not be cut or constructed concurrently.
+            struct scratch_space {
+                // Stacks for cutting
+                internal::banana_stack<sign> L_stack;
+                internal::banana_stack<sign> M_stack;
+                internal::banana_stack<sign> R_stack;
+                // Copies of the opposite tree's stacks for cuts of both trees that run concurrently
+                internal::banana_stack<-sign> L_inv_stack;
+                internal::banana_stack<-sign> R_inv_stack;
+                // Items and stack for constructing
+                recycling_object_pool<construction_item> construction_item_pool;
+                std::vector<min_max_pair<construction_item*>> construction_stack;
+
+                // Number of cuts and constructions that used this scratch space
+                size_t number_of_uses = 0;
+                // Number of uses that had to allocate memory
+                size_t number_of_growths = 0;
+
+                // Empty the stacks before a cut or construction.
+                void begin_use() {
+                    L_stack.clear();
+                    M_stack.clear();
+                    R_stack.clear();
+                    L_inv_stack.clear();
+                    R_inv_stack.clear();
+                    construction_stack.clear();
+                    capacity_at_begin = capacity();
+                    number_of_uses++;
+                }
+                // Record whether the cut or construction had to allocate memory.
+                void end_use() {
+                    number_of_growths += static_cast<size_t>(capacity() != capacity_at_begin);
+                }
+
+                // Returns the number of bytes allocated by the stacks and the pool of construction items.
+                [[nodiscard]] size_t get_memory_bytes() const {
+                    return (L_stack.capacity() + M_stack.capacity() + R_stack.capacity()) *
+                               sizeof(typename internal::banana_stack<sign>::banana_type) +
+                           (L_inv_stack.capacity() + R_inv_stack.capacity()) *
+                               sizeof(typename internal::banana_stack<-sign>::banana_type) +
+                           construction_stack.capacity() * sizeof(min_max_pair<construction_item*>) +
+                           construction_item_pool.get_allocated_bytes();
+                }
+
+            private:
+                size_t capacity_at_begin = 0;
+
+                // Returns a measure of the allocated memory that only grows.
+                size_t capacity() const {
+                    return L_stack.capacity() + M_stack.capacity() + R_stack.capacity() +
+                           L_inv_stack.capacity() + R_inv_stack.capacity() + construction_stack.capacity() +
+                           static_cast<size_t>(construction_item_pool.get_number_of_allocations());
+                }
+            };
+
     };
 
     //
@@ -887,19 +999,42 @@ namespace bananas {
     bool operator!=(const string_iterator<node_type> &a,
                     const string_iterator<node_type> &b);
 
+    class interchange_worker;
+
+    // Scratch space for the up-tree and the down-tree of a `persistence_data_structure`.
+    struct persistence_scratch_space {
+        banana_tree<1>::scratch_space up_tree_scratch;
+        banana_tree< -1>::scratch_space down_tree_scratch;
+        // If given, local operations with many interchanges perform the interchanges in the opposite tree
+        // on this worker, concurrently with those in the tree of the changed item.
+        interchange_worker* worker = nullptr;
+        // If given, cuts with at least `min_bananas_for_parallel_cut` bananas on the stacks of both trees
+        // run the main loop of the down-tree on this worker, concurrently with that of the up-tree.
+        interchange_worker* cut_worker = nullptr;
+        // Waking the worker and copying the stacks costs 5-10us, while cutting costs about 100ns per banana,
+        // as measured by `ex_topological_maintenance wc-cut` with and without `--parallel-cuts`,
+        // so the worker only pays off for cuts with about a thousand bananas.
+        // Cuts of random walks load 5-20 bananas and always run serially.
+        constexpr static size_t min_bananas_for_parallel_cut = 1024;
+    };
+
     // A wrapper around a pair of banana trees, i.e., an up-tree and a down-tree.
     // This manages the pair of up-tree and down-tree
     class persistence_data_structure {
 
         public:
             persistence_data_structure(recycling_object_pool<up_tree_node> &up_tree_node_pool,
-                                       recycling_object_pool<down_tree_node> &down_tree_node_pool);
+                                       recycling_object_pool<down_tree_node> &down_tree_node_pool,
+                                       persistence_scratch_space* scratch = nullptr);
             persistence_data_structure(recycling_object_pool<up_tree_node> &up_tree_node_pool,
                                        recycling_object_pool<down_tree_node> &down_tree_node_pool,
                                        list_item* left_endpoint,
-                                       list_item* right_endpoint);
+                                       list_item* right_endpoint,
+                                       persistence_scratch_space* scratch = nullptr);
 
             void construct(list_item* left_endpoint, list_item* right_endpoint);
+            // Free the nodes of both trees, which leaves empty trees that can be constructed anew.
+            void clear();
 
             //
             // Local maintenance operations
@@ -1007,6 +1142,13 @@ namespace bananas {
         private:
             banana_tree<1> up_tree;
             banana_tree< -1> down_tree;
+            // Scratch space shared with other data structures, or `nullptr`
+            persistence_scratch_space* scratch;
+
+            // Run `operation`, which changes the value of a critical item in the tree with the given `sign`,
+            // with a callback that performs the corresponding interchanges in the opposite tree.
+            template<int sign, typename T>
+            void interchange_in_opposite_tree(const T &operation);
     };
 
 }
@@ -1,6 +1,8 @@
 //
 // This file implements the construction algorithm for the banana tree.
 //
+#include <optional>
+
 #include "datastructure/banana_tree.h"
 #include "datastructure/banana_tree_sign_template.h"
 #include "persistence_defs.h"
@@ -16,8 +18,12 @@ void banana_tree<sign>::construct_impl(list_item *left_endpoint,
 
     TIME_BEGIN(construct_prepare);
 
+    std::optional<scratch_space> own_scratch;
+    auto &construction_scratch = scratch != nullptr ? *scratch : own_scratch.emplace();
+    construction_scratch.begin_use();
+
     // Extract critical items from the list of all items
-    auto construction_item_pool = recycling_object_pool<construction_item>{};
+    auto &construction_item_pool = construction_scratch.construction_item_pool;
     auto prev_item = construction_item_pool.construct(nullptr, nullptr, left_endpoint);
     this->allocate_node(left_endpoint);
     auto left_c_endpoint = prev_item;
@@ -79,8 +85,7 @@ void banana_tree<sign>::construct_impl(list_item *left_endpoint,
     TIME_END(construct_prepare, sign);
     TIME_BEGIN(construct_loop);
 
-    using stack_pair = min_max_pair<construction_item*>;
-    std::vector<stack_pair> the_stack;
+    auto &the_stack = construction_scratch.construction_stack;
     the_stack.push_back({&fake_left, &fake_left});
 
     // Make the `down`-pointer of the fake left node point somewhere
@@ -137,6 +142,13 @@ void banana_tree<sign>::construct_impl(list_item *left_endpoint,
     if (added_right_hook) {
         right_hook_item.cut_left();
     }
+    // Return the construction items to the scratch space.
+    for (auto* c_item = left_c_endpoint; c_item != &fake_right;) {
+        auto* next = c_item->next;
+        construction_item_pool.free(c_item);
+        c_item = next;
+    }
+    construction_scratch.end_use();
 
     TIME_END(construct_cleanup, sign);
 }
@@ -3,6 +3,7 @@
 #include "datastructure/banana_tree.h"
 #include "datastructure/banana_tree_sign_template.h"
 #include "datastructure/dictionary.h"
+#include "datastructure/interchange_worker.h"
 #include "datastructure/list_item.h"
 #include "persistence_defs.h"
 #include "utility/errors.h"
@@ -522,6 +523,13 @@ void banana_tree<sign>::min_slide(list_item* old_min, list_item* new_min) {
         auto is_left = old_min->is_left_endpoint();
         auto hook_node = is_left ? allocate_node(&left_hook_item) :
                                    allocate_node(&right_hook_item);
+        // The hook item may be stale, since hook items without a node are not kept up to date
+        // when the value of an endpoint changes or when trees are glued or cut.
+        if (is_left) {
+            assign_hook_value_and_order<true>(old_min);
+        } else {
+            assign_hook_value_and_order<false>(old_min);
+        }
         auto old_min_new_node = allocate_node(old_min);
         old_min_new_node->set_pointers(old_min_node->death,
                                        old_min_node,
@@ -800,40 +808,44 @@ void banana_tree<sign>::update_global_max() {
 // Implementation of local operations in `persistence_data_structure`
 //
 
-void persistence_data_structure::on_increase_value_of_maximum(list_item* max_item) {
-    up_tree.on_increase_value_of_maximum(max_item, [](up_tree_node* above, up_tree_node* below) {
-        auto *down_above = above->get_opposite_node();
-        auto *down_below = below->get_opposite_node();
+template<int sign, typename T>
+void persistence_data_structure::interchange_in_opposite_tree(const T &operation) {
+    auto* worker = scratch != nullptr ? scratch->worker : nullptr;
+    operation([worker](banana_tree_node<sign>* above, banana_tree_node<sign>* below) {
+        auto *opposite_above = above->get_opposite_node();
+        auto *opposite_below = below->get_opposite_node();
         // Flipping the sign changes the meaning of above and below:
-        // in the down-tree `above` goes below `below`, even though `above` goes above `below` in the up-tree.
-        down_above->min_interchange_below(down_below);
+        // in the opposite tree `above` goes below `below`, even though `above` goes above `below` in this tree.
+        if (worker == nullptr) {
+            opposite_above->min_interchange_below(opposite_below);
+        } else {
+            // The worker performs the interchanges itself if there are too few to hand them over.
+            worker->push(opposite_above, opposite_below);
+        }
+    });
+    if (worker != nullptr) {
+        worker->wait();
+    }
+}
+
+void persistence_data_structure::on_increase_value_of_maximum(list_item* max_item) {
+    interchange_in_opposite_tree<1>([this, max_item](const auto &callback) {
+        up_tree.on_increase_value_of_maximum(max_item, callback);
     });
 }
 void persistence_data_structure::on_decrease_value_of_maximum(list_item* max_item) {
-    up_tree.on_decrease_value_of_maximum(max_item, [](up_tree_node* above, up_tree_node* below) {
-        auto *down_above = above->get_opposite_node();
-        auto *down_below = below->get_opposite_node();
-        // Flipping the sign changes the meaning of above and below:
-        // in the down-tree `above` goes below `below`, even though `above` goes above `below` in the up-tree.
-        down_above->min_interchange_below(down_below);
+    interchange_in_opposite_tree<1>([this, max_item](const auto &callback) {
+        up_tree.on_decrease_value_of_maximum(max_item, callback);
     });
 }
 void persistence_data_structure::on_increase_value_of_minimum(list_item* min_item) {
-    down_tree.on_decrease_value_of_maximum(min_item, [](down_tree_node* above, down_tree_node* below) {
-        auto *up_above = above->get_opposite_node();
-        auto *up_below = below->get_opposite_node();
-        // Flipping the sign changes the meaning of above and below:
-        // in the up-tree `above` goes below `below`, even though `above` goes above `below` in the down-tree.
-        up_above->min_interchange_below(up_below);
+    interchange_in_opposite_tree<-1>([this, min_item](const auto &callback) {
+        down_tree.on_decrease_value_of_maximum(min_item, callback);
     });
 }
 void persistence_data_structure::on_decrease_value_of_minimum(list_item* min_item) {
-    down_tree.on_increase_value_of_maximum(min_item, [](down_tree_node* above, down_tree_node* below) {
-        auto *up_above = above->get_opposite_node();
-        auto *up_below = below->get_opposite_node();
-        // Flipping the sign changes the meaning of above and below:
-        // in the up-tree `above` goes below `below`, even though `above` goes above `below` in the down-tree.
-        up_above->min_interchange_below(up_below);
+    interchange_in_opposite_tree<-1>([this, min_item](const auto &callback) {
+        down_tree.on_increase_value_of_maximum(min_item, callback);
     });
 }
 
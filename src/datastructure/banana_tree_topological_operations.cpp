@@ -10,6 +10,7 @@
 #include "datastructure/banana_tree_sign_template.h"
 #include "datastructure/banana_tree_validation.h"
 #include "datastructure/dictionary.h"
+#include "datastructure/interchange_worker.h"
 #include "datastructure/list_item.h"
 #include "persistence_defs.h"
 #include "utility/debug.h"
@@ -56,6 +57,28 @@ bool internal::banana_stack<sign>::empty() const {
     return top_iter == stack.rend();
 }
 
+SIGN_TEMPLATE
+void internal::banana_stack<sign>::clear() {
+    stack.clear();
+    reset_top();
+}
+
+SIGN_TEMPLATE
+void internal::banana_stack<sign>::assign(const banana_stack &other) {
+    stack.assign(other.stack.begin(), other.stack.end());
+    reset_top();
+}
+
+SIGN_TEMPLATE
+size_t internal::banana_stack<sign>::size() const {
+    return stack.size();
+}
+
+SIGN_TEMPLATE
+size_t internal::banana_stack<sign>::capacity() const {
+    return stack.capacity();
+}
+
 SIGN_TEMPLATE
 std::optional<internal::stack_variant> internal::top_banana(banana_stack<sign> &L_stack,
                                                             banana_stack<sign> &M_stack,
@@ -264,6 +287,7 @@ void banana_tree<sign>::glue_to_right(tree_type &right_tree, signed_min_dictiona
     // Ensure up/down assumption:
     // One interval ends in an up-type item, the other ends in a down-type item
     // and the up-type item has lower value than the down-type item.
+    const list_item &last_left_item = *right_endpoint;
     auto [left_glue_node, right_glue_node] = prepare_gluing_to_right(right_tree, min_dict);
     auto *left_special_root = get_special_root();
     const auto *right_special_root = right_tree.get_special_root();
@@ -362,6 +386,10 @@ void banana_tree<sign>::glue_to_right(tree_type &right_tree, signed_min_dictiona
         std::swap(left_special_root->low->in, left_special_root->low->mid);
     }
 
+    // Undoing the bananas above labels the nodes by the spines of the trees before gluing,
+    // so relabel the spines of the glued tree.
+    relabel_glued_spines(last_left_item);
+
     // update the global max
     if (this->global_max->template value<sign>() < right_tree.global_max->template value<sign>()) {
         global_max = right_tree.global_max;
@@ -681,6 +709,32 @@ void banana_tree<sign>::ensure_glued_tree_is_this(node_ptr_type other_special_ro
     dummy_node->mid = other_special_root;
 }
 
+SIGN_TEMPLATE
+void banana_tree<sign>::relabel_glued_spines(const list_item &last_left_item) {
+    // Gluing only undoes bananas on the right spine of the left tree and on the left spine of the right tree,
+    // so the left spine of the glued tree ends in that of the left tree, and the right spine in that of the right tree.
+    // Only the nodes above need to be relabelled, which takes time linear in the number of undone bananas
+    // instead of in the lengths of the spines.
+    auto* special_root_node = special_root_item.get_node<sign>();
+    special_root_node->spine_label = internal::spine_pos::on_both_spines;
+    auto* node_left = special_root_node->in;
+    while (node_left->spine_label != internal::spine_pos::on_left_spine || last_left_item < *node_left->item) {
+        node_left->spine_label = internal::spine_pos::on_left_spine;
+        if (node_left->is_leaf()) {
+            break;
+        }
+        node_left = node_left->in;
+    }
+    auto* node_right = special_root_node->mid;
+    while (node_right->spine_label != internal::spine_pos::on_right_spine || *node_right->item <= last_left_item) {
+        node_right->spine_label = internal::spine_pos::on_right_spine;
+        if (node_right->is_leaf()) {
+            break;
+        }
+        node_right = node_right->in;
+    }
+}
+
 //
 // Implementation of the cutting algorithm in `banana_tree`
 //
@@ -770,6 +824,7 @@ void banana_tree<sign>::load_stacks(const list_item& virtual_item,
 SIGN_TEMPLATE
 void banana_tree<sign>::initialize_empty_cut_tree(bool left) {
     auto* special_root_node = allocate_node(&special_root_item);
+    special_root_node->spine_label = internal::spine_pos::on_both_spines;
     node_ptr_type hook_node;
     if (left) {
         special_root_item.assign_order(-std::numeric_limits<interval_order_type>::infinity());
@@ -816,23 +871,23 @@ bool banana_tree<sign>::cut(list_item& cut_item,
                             internal::banana_stack<sign> &R_stack,
                             internal::banana_stack<-sign> &L_inv_stack,
                             internal::banana_stack<-sign> &R_inv_stack) {
+    auto state = begin_cut(cut_item, left_of_cut, right_of_cut, other_tree, L_stack, M_stack, R_stack, L_inv_stack, R_inv_stack);
+    finish_cut(state, left_of_cut, right_of_cut, other_tree);
+    return state.cuts_left;
+}
+
+SIGN_TEMPLATE
+typename banana_tree<sign>::cut_state banana_tree<sign>::begin_cut(list_item& cut_item,
+                                                                   list_item& left_of_cut,
+                                                                   list_item& right_of_cut,
+                                                                   tree_type &other_tree,
+                                                                   internal::banana_stack<sign> &L_stack,
+                                                                   internal::banana_stack<sign> &M_stack,
+                                                                   internal::banana_stack<sign> &R_stack,
+                                                                   internal::banana_stack<-sign> &L_inv_stack,
+                                                                   internal::banana_stack<-sign> &R_inv_stack) {
     TIME_BEGIN(cut_preprocess);
 
-    // If the top banana on L_inv_stack (or R_inv_stack) has a node on the spine in the opposite tree,
-    // then this banana is not a banana in this tree.
-    // We pop these bananas from their stack since we don't need to process them here.
-    // They are placed back on the stack at the very end of this function.
-    // TODO: check that this always works
-    std::optional<internal::item_pair<-sign>> L_inv_top;
-    std::optional<internal::item_pair<-sign>> R_inv_top;
-    if (!L_inv_stack.empty() && L_inv_stack.top().template get_max<-sign>()->template get_node<-sign>()->is_on_spine()) {
-        L_inv_top = L_inv_stack.top();
-        L_inv_stack.actually_pop();
-    }
-    if (!R_inv_stack.empty() && R_inv_stack.top().template get_max<-sign>()->template get_node<-sign>()->is_on_spine()) {
-        R_inv_top = R_inv_stack.top();
-        R_inv_stack.actually_pop();
-    }
     auto modified_stack_opt = internal::add_missing_short_wave_banana(L_stack, M_stack, R_stack, L_inv_stack, R_inv_stack, cut_item.value<sign>());
 
     // First determine whether we cut left or right.
@@ -883,32 +938,32 @@ bool banana_tree<sign>::cut(list_item& cut_item,
     auto* dummy_node = other_tree.get_special_root()->get_birth();
     cut_loop(cut_item, dummy_node, L_stack, M_stack, R_stack, L_inv_stack, R_inv_stack);
 
+    return {cuts_left, dummy_node, modified_stack_opt};
+}
+
+SIGN_TEMPLATE
+void banana_tree<sign>::finish_cut(cut_state &state,
+                                   list_item& left_of_cut,
+                                   list_item& right_of_cut,
+                                   tree_type &other_tree) {
     TIME_BEGIN(cut_postprocess);
 
     // Ensure correct position of the special root of `other_tree`
     // and correct in-/mid-trails in special banana of `other_tree`
-    other_tree.fix_special_root_after_cut(cuts_left);
+    other_tree.fix_special_root_after_cut(state.cuts_left);
     massert(this->get_special_root()->is_special_root(), "Expected the special root to be a special root, but it's not.");
     // Assign order of `dummy_node`/its item.
     // Reassign hook nodes to hook items in left/right tree.
-    update_hooks_after_cut(other_tree, left_of_cut, right_of_cut, dummy_node, cuts_left);
+    update_hooks_after_cut(other_tree, left_of_cut, right_of_cut, state.dummy_node, state.cuts_left);
 
     update_global_max();
 
     // Clean up the stack we modified in the beginning.
-    if (modified_stack_opt.has_value()) {
-        internal::actually_pop_from_var_stack(modified_stack_opt.value());
-    }
-    if (L_inv_top.has_value()) {
-        L_inv_stack.push(L_inv_top.value());
-    }
-    if (R_inv_top.has_value()) {
-        R_inv_stack.push(R_inv_top.value());
+    if (state.modified_stack.has_value()) {
+        internal::actually_pop_from_var_stack(state.modified_stack.value());
     }
 
     TIME_END(cut_postprocess, sign);
-
-    return cuts_left;
 }
 
 SIGN_TEMPLATE
@@ -919,6 +974,12 @@ void banana_tree<sign>::cut_loop(list_item& cut_item,
                                  internal::banana_stack<sign> &R_stack,
                                  internal::banana_stack<-sign> &L_inv_stack,
                                  internal::banana_stack<-sign> &R_inv_stack) {
+    // A special root stays on both spines when it becomes the maximum of an injured or killed banana.
+    auto assign_spine_label = [](node_ptr_type max_node, internal::spine_pos spine_label) {
+        if (!max_node->is_special_root()) {
+            max_node->spine_label = spine_label;
+        }
+    };
     while (true) {
         auto stack_opt = internal::top_banana(L_stack, M_stack, R_stack, L_inv_stack, R_inv_stack);
         if (!stack_opt.has_value()) {
@@ -931,19 +992,19 @@ void banana_tree<sign>::cut_loop(list_item& cut_item,
         internal::pop_from_var_stack(stack_var);
         if (internal::holds_stack(stack_var, L_stack)) {
             DEBUG_MSG("do_injury (L) with min " << min_node->item->get_interval_order() << " and max " << max_node->item->get_interval_order());
-            max_node->spine_label = internal::spine_pos::on_right_spine;
+            assign_spine_label(max_node, internal::spine_pos::on_right_spine);
             do_injury(cut_item, max_node, dummy_node);
         } else if (internal::holds_stack(stack_var, M_stack)) {
             if (cut_item < *(max_node->get_item())) {
-                max_node->spine_label = internal::spine_pos::on_left_spine;
+                assign_spine_label(max_node, internal::spine_pos::on_left_spine);
             } else {
-                max_node->spine_label = internal::spine_pos::on_right_spine;
+                assign_spine_label(max_node, internal::spine_pos::on_right_spine);
             }
             DEBUG_MSG("do_fatality with min " << min_node->item->get_interval_order() << " and max " << max_node->item->get_interval_order());
             do_fatality(cut_item, min_node, max_node, dummy_node);
         } else if (internal::holds_stack(stack_var, R_stack)) {
             DEBUG_MSG("do_injury (R) with min " << min_node->item->get_interval_order() << " and max " << max_node->item->get_interval_order());
-            max_node->spine_label = internal::spine_pos::on_left_spine;
+            assign_spine_label(max_node, internal::spine_pos::on_left_spine);
             do_injury(cut_item, max_node, dummy_node);
         } else if (internal::holds_stack(stack_var, L_inv_stack)) {
             DEBUG_MSG("do_scare (L) with min " << min_node->item->get_interval_order() << " and max " << max_node->item->get_interval_order());
@@ -971,6 +1032,14 @@ void banana_tree<sign>::fix_special_root_after_cut(bool cuts_left) {
     auto* special_root_node = get_special_root();
     special_root_node->in->spine_label = internal::spine_pos::on_left_spine;
     special_root_node->mid->spine_label = internal::spine_pos::on_right_spine;
+    // Minimum interchanges during the cut label the spine by the trails of the special root
+    // before they were swapped above, so relabel the spine at the cut.
+    const auto cut_spine_label = cuts_left ? internal::spine_pos::on_right_spine : internal::spine_pos::on_left_spine;
+    auto* spine_node = cuts_left ? special_root_node->mid : special_root_node->in;
+    while (!spine_node->is_leaf()) {
+        spine_node = spine_node->in;
+        spine_node->spine_label = cut_spine_label;
+    }
     update_global_max();
     massert(global_max != nullptr, "Expected to have a global max.");
     massert(get_special_root()->is_special_root(), "Expected the special root to be a special root, but it's not.");
@@ -1189,11 +1258,39 @@ void persistence_data_structure::glue_to_right(persistence_data_structure &right
     down_tree.glue_to_right(right_persistence.down_tree, max_dict);
 }
 
+// Helper function for `persistence_data_structure::cut`:
+// check whether the maximum of the top banana on `stack` is on the spine of its tree.
+SIGN_TEMPLATE
+bool top_is_on_spine(internal::banana_stack<sign> &stack) {
+    return !stack.empty() && stack.top().template get_max<sign>()->template get_node<sign>()->is_on_spine();
+}
+
+// Helper function for `persistence_data_structure::cut`:
+// remove the top banana from `stack` if `hold_back` is true and return it.
+SIGN_TEMPLATE
+std::optional<internal::item_pair<sign>> hold_back_top(internal::banana_stack<sign> &stack, bool hold_back) {
+    if (!hold_back) {
+        return std::nullopt;
+    }
+    auto top = stack.top();
+    stack.actually_pop();
+    return top;
+}
+
+// Helper function for `persistence_data_structure::cut`:
+// place a banana removed by `hold_back_top` back onto `stack`.
+SIGN_TEMPLATE
+void restore_top(internal::banana_stack<sign> &stack, const std::optional<internal::item_pair<sign>> &top) {
+    if (top.has_value()) {
+        stack.push(top.value());
+    }
+}
+
 persistence_data_structure persistence_data_structure::cut(list_item& left_of_cut,
                                                            list_item& right_of_cut,
                                                            min_dictionary &min_dict,
                                                            max_dictionary &max_dict) {
-    persistence_data_structure other_persistence(up_tree.node_pool, down_tree.node_pool);
+    persistence_data_structure other_persistence(up_tree.node_pool, down_tree.node_pool, scratch);
     
     list_item cut_item{(left_of_cut.get_interval_order() + right_of_cut.get_interval_order()) / 2,
                        (left_of_cut.value<1>() + right_of_cut.value<1>()) / 2};
@@ -1217,21 +1314,99 @@ persistence_data_structure persistence_data_structure::cut(list_item& left_of_cu
 
     left_of_cut.cut_right();
 
-    internal::banana_stack<1> Lup_stack, Mup_stack, Rup_stack;
-    internal::banana_stack<-1> Ldn_stack, Mdn_stack, Rdn_stack;
+    std::optional<persistence_scratch_space> own_scratch;
+    auto &cut_scratch = scratch != nullptr ? *scratch : own_scratch.emplace();
+    cut_scratch.up_tree_scratch.begin_use();
+    cut_scratch.down_tree_scratch.begin_use();
+    auto &Lup_stack = cut_scratch.up_tree_scratch.L_stack;
+    auto &Mup_stack = cut_scratch.up_tree_scratch.M_stack;
+    auto &Rup_stack = cut_scratch.up_tree_scratch.R_stack;
+    auto &Ldn_stack = cut_scratch.down_tree_scratch.L_stack;
+    auto &Mdn_stack = cut_scratch.down_tree_scratch.M_stack;
+    auto &Rdn_stack = cut_scratch.down_tree_scratch.R_stack;
     up_tree.load_stacks(cut_item, smallest_up_banana, Lup_stack, Mup_stack, Rup_stack);
     down_tree.load_stacks(cut_item, smallest_dn_banana, Ldn_stack, Mdn_stack, Rdn_stack);
-    const bool up_cuts_left = up_tree.cut(cut_item, left_of_cut, right_of_cut,
+
+    // If the top banana on an L- or R-stack has its maximum on the spine,
+    // then this banana is not a banana in the opposite tree,
+    // so it is held back while cutting the opposite tree.
+    // This has to be decided before cutting either tree,
+    // since cutting the up-tree relabels its spine.
+    const bool Lup_top_on_spine = top_is_on_spine(Lup_stack);
+    const bool Rup_top_on_spine = top_is_on_spine(Rup_stack);
+    const bool Ldn_top_on_spine = top_is_on_spine(Ldn_stack);
+    const bool Rdn_top_on_spine = top_is_on_spine(Rdn_stack);
+
+    bool up_cuts_left;
+    bool down_cuts_left;
+    // Small cuts run serially, since waking the worker and copying the stacks costs more than cutting the down-tree.
+    const size_t num_bananas = Lup_stack.size() + Mup_stack.size() + Rup_stack.size()
+                             + Ldn_stack.size() + Mdn_stack.size() + Rdn_stack.size();
+    if (cut_scratch.cut_worker != nullptr && num_bananas >= persistence_scratch_space::min_bananas_for_parallel_cut) {
+        // The down-tree is cut on the worker between `execute` and `wait`:
+        // - `execute` hands over the task under the worker's mutex, so the worker sees the loaded stacks and their copies.
+        // - Until `wait`, each tree writes only its own nodes, stacks and node pool. Both read the values and orders of items,
+        //   which don't change until `finish_cut`, and the opposite tree's L- and R-stacks.
+        //   Both trees pop from their own stacks while cutting, so each tree reads a copy of the opposite tree's stacks
+        //   instead of synchronizing every pop. Copying takes time linear in the number of bananas on the stacks,
+        //   which cutting spends on them anyway.
+        // - `wait` returns after the worker has finished the task, with acquire ordering,
+        //   so `finish_cut` sees the down-tree as the worker left it.
+        auto &Ldn_copy = cut_scratch.up_tree_scratch.L_inv_stack;
+        auto &Rdn_copy = cut_scratch.up_tree_scratch.R_inv_stack;
+        auto &Lup_copy = cut_scratch.down_tree_scratch.L_inv_stack;
+        auto &Rup_copy = cut_scratch.down_tree_scratch.R_inv_stack;
+        Ldn_copy.assign(Ldn_stack);
+        Rdn_copy.assign(Rdn_stack);
+        Lup_copy.assign(Lup_stack);
+        Rup_copy.assign(Rup_stack);
+        hold_back_top(Ldn_copy, Ldn_top_on_spine);
+        hold_back_top(Rdn_copy, Rdn_top_on_spine);
+        hold_back_top(Lup_copy, Lup_top_on_spine);
+        hold_back_top(Rup_copy, Rup_top_on_spine);
+
+        std::optional<banana_tree< -1>::cut_state> down_state;
+        auto cut_down_tree = [&]() {
+            down_state = down_tree.begin_cut(cut_item, left_of_cut, right_of_cut,
+                                             other_persistence.down_tree,
+                                             Ldn_stack, Mdn_stack, Rdn_stack, Lup_copy, Rup_copy);
+        };
+        cut_scratch.cut_worker->execute(cut_down_tree);
+        auto up_state = up_tree.begin_cut(cut_item, left_of_cut, right_of_cut,
                                           other_persistence.up_tree,
-                                          Lup_stack, Mup_stack, Rup_stack, Ldn_stack, Rdn_stack);
-    Lup_stack.reset_top(); Mup_stack.reset_top(); Rup_stack.reset_top();
-    Ldn_stack.reset_top(); Mdn_stack.reset_top(); Rdn_stack.reset_top();
-    const bool down_cuts_left = down_tree.cut(cut_item, left_of_cut, right_of_cut,
-                                              other_persistence.down_tree,
-                                              Ldn_stack, Mdn_stack, Rdn_stack, Lup_stack, Rup_stack);
+                                          Lup_stack, Mup_stack, Rup_stack, Ldn_copy, Rdn_copy);
+        cut_scratch.cut_worker->wait();
+        // Updating the hooks changes values and orders of items,
+        // so it waits until neither tree reads the opposite tree's stacks anymore.
+        up_tree.finish_cut(up_state, left_of_cut, right_of_cut, other_persistence.up_tree);
+        down_tree.finish_cut(down_state.value(), left_of_cut, right_of_cut, other_persistence.down_tree);
+        up_cuts_left = up_state.cuts_left;
+        down_cuts_left = down_state->cuts_left;
+    } else {
+        auto Ldn_top = hold_back_top(Ldn_stack, Ldn_top_on_spine);
+        auto Rdn_top = hold_back_top(Rdn_stack, Rdn_top_on_spine);
+        up_cuts_left = up_tree.cut(cut_item, left_of_cut, right_of_cut,
+                                   other_persistence.up_tree,
+                                   Lup_stack, Mup_stack, Rup_stack, Ldn_stack, Rdn_stack);
+        restore_top(Ldn_stack, Ldn_top);
+        restore_top(Rdn_stack, Rdn_top);
+
+        Lup_stack.reset_top(); Mup_stack.reset_top(); Rup_stack.reset_top();
+        Ldn_stack.reset_top(); Mdn_stack.reset_top(); Rdn_stack.reset_top();
+
+        auto Lup_top = hold_back_top(Lup_stack, Lup_top_on_spine);
+        auto Rup_top = hold_back_top(Rup_stack, Rup_top_on_spine);
+        down_cuts_left = down_tree.cut(cut_item, left_of_cut, right_of_cut,
+                                       other_persistence.down_tree,
+                                       Ldn_stack, Mdn_stack, Rdn_stack, Lup_stack, Rup_stack);
+        restore_top(Lup_stack, Lup_top);
+        restore_top(Rup_stack, Rup_top);
+    }
     if (up_cuts_left != down_cuts_left) {
         swap(down_tree, other_persistence.down_tree);
     }
 
+    cut_scratch.up_tree_scratch.end_use();
+    cut_scratch.down_tree_scratch.end_use();
     return other_persistence;
 }
@@ -0,0 +1,350 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <latch>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "algorithms/banana_tree_algorithms.h"
+#include "datastructure/banana_tree.h"
+#include "datastructure/batch_construction.h"
+#include "datastructure/interval.h"
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
+#include "persistence_defs.h"
+#include "utility/errors.h"
+#include "utility/stats.h"
+
+using namespace bananas;
+using persistence_diagram::diagram_type::essential;
+using persistence_diagram::diagram_type::ordinary;
+using persistence_diagram::diagram_type::relative;
+
+namespace {
+
+// Number of series a thread takes at once
+constexpr size_t chunk_size = 16;
+
+// Call `work(state, first, last)` for chunks of the tasks `0, ..., num_tasks - 1` on `num_threads` threads,
+// each of which owns a default-constructed `State` that it reuses for all of its chunks.
+// The statistics of the other threads are added to those of the calling thread.
+template<typename State, typename Work>
+void run_in_chunks(size_t num_tasks, size_t tasks_per_chunk, size_t num_threads, Work work) {
+    const auto num_chunks = (num_tasks + tasks_per_chunk - 1) / tasks_per_chunk;
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads = std::max<size_t>(1, std::min(num_threads, num_chunks));
+
+    std::atomic<size_t> next_task{0};
+    auto run = [&work, &next_task, num_tasks, tasks_per_chunk]() {
+        State state;
+        while (true) {
+            const auto first = next_task.fetch_add(tasks_per_chunk, std::memory_order_relaxed);
+            if (first >= num_tasks) {
+                return;
+            }
+            work(state, first, std::min(first + tasks_per_chunk, num_tasks));
+        }
+    };
+    // The other threads hand over their statistics one at a time, once the calling thread has finished its chunks.
+    const auto caller_statistics = thread_statistics::of_this_thread();
+    std::latch caller_done(1);
+    std::mutex statistics_mutex;
+    std::vector<std::thread> threads;
+    for (size_t thread_idx = 1; thread_idx < num_threads; ++thread_idx) {
+        threads.emplace_back([&run, &caller_statistics, &caller_done, &statistics_mutex]() {
+            run();
+            caller_done.wait();
+            std::lock_guard lock(statistics_mutex);
+            caller_statistics.take(thread_statistics::of_this_thread());
+        });
+    }
+    run();
+    caller_done.count_down();
+    for (auto &thread: threads) {
+        thread.join();
+    }
+}
+
+// Move the `num_pairs[series]` pairs of each series from the start of its slot, which begins at `slot_begin(series)`,
+// to the front of `diagrams.pairs` and set `diagrams.offsets`.
+// Slots only move to the left, so the pairs can be moved in place.
+template<typename SlotBegin>
+void compact_slots(diagram_batch &diagrams, const std::vector<size_t> &num_pairs, SlotBegin slot_begin) {
+    const auto num_series = num_pairs.size();
+    diagrams.offsets.resize(num_series + 1);
+    diagrams.offsets[0] = 0;
+    for (size_t series = 0; series < num_series; ++series) {
+        const auto begin = diagrams.offsets[series];
+        std::memmove(diagrams.pairs.data() + begin,
+                     diagrams.pairs.data() + slot_begin(series),
+                     num_pairs[series] * sizeof(indexed_persistent_pair));
+        diagrams.offsets[series + 1] = begin + num_pairs[series];
+    }
+    diagrams.pairs.resize(diagrams.offsets.back());
+}
+
+//
+// Construction of banana trees
+//
+
+uint32_t index_of(const list_item* item) {
+    return static_cast<uint32_t>(item->get_interval_order());
+}
+
+// Write the persistent pairs of `the_interval` to `out`, which has room for one pair per item,
+// and return the number of pairs.
+size_t write_pairs(const interval &the_interval, indexed_persistent_pair* out) {
+    size_t num_pairs = 0;
+    map_persistent_pairs(the_interval.get_up_tree(), the_interval.get_down_tree(),
+                         [out, &num_pairs](const list_item* birth, const list_item* death,
+                                           persistence_diagram::diagram_type type) {
+        const auto death_idx = std::isinf(death->get_interval_order()) ? indexed_persistent_pair::special_root
+                                                                       : index_of(death);
+        out[num_pairs++] = {index_of(birth), death_idx, type};
+    });
+    return num_pairs;
+}
+
+struct construction_state {
+    persistence_context context;
+    std::vector<function_value_type> values;
+};
+
+//
+// Lane-parallel pairing
+//
+
+// Critical items of a lane are identified by their sample index; the remaining items used by the construction
+// of a banana tree are identified by indices beyond the samples.
+enum class lane_item : uint8_t { noncritical = 0, minimum = 1, maximum = 2 };
+
+struct lane_state {
+    // The samples of the lanes that are processed together, interleaved like in `interleaved_series_batch`
+    std::vector<function_value_type> values;
+    // The type of sample `i` of lane `lane` in the up-tree is `types[i * lane_width + lane]`.
+    std::vector<lane_item> types;
+    // The stack of the construction loop, storing pairs of a minimum and a maximum.
+    std::vector<std::pair<int64_t, int64_t>> stack;
+};
+
+// Pair the critical items of one lane like the construction loop in `banana_tree::construct_impl`,
+// but without building the tree, and write the pairs to `out`. Returns the number of pairs.
+// `values` are the samples of all lanes, `lane` selects the lane and `stride` is the number of lanes.
+template<int sign>
+    requires sign_integral<decltype(sign), sign>
+size_t pair_lane(const function_value_type* values, size_t stride, size_t lane, size_t num_items,
+                 const std::vector<lane_item> &types, std::vector<std::pair<int64_t, int64_t>> &stack,
+                 uint32_t global_max, indexed_persistent_pair* out) {
+    const auto n = static_cast<int64_t>(num_items);
+    // Items beyond the samples
+    const int64_t fake_left = -2;
+    const int64_t left_hook = -1;
+    const int64_t right_hook = n;
+    const int64_t special_root = n + 1;
+    constexpr auto infinity = std::numeric_limits<function_value_type>::infinity();
+
+    auto sample = [values, stride, lane](int64_t idx) {
+        return sign * values[static_cast<size_t>(idx) * stride + lane];
+    };
+    auto value = [&sample, n](int64_t idx) {
+        if (idx < -1 || idx > n) {
+            return infinity;
+        }
+        if (idx == -1) {
+            return next_smaller(sample(0));
+        }
+        if (idx == n) {
+            return next_smaller(sample(n - 1));
+        }
+        return sample(idx);
+    };
+    auto is_minimum = [&types, stride, lane, n](int64_t idx) {
+        if (idx == -1 || idx == n) {
+            return true;
+        }
+        if (idx == n + 1) {
+            return false;
+        }
+        const auto type = types[static_cast<size_t>(idx) * stride + lane];
+        return type == (sign == 1 ? lane_item::minimum : lane_item::maximum);
+    };
+
+    size_t num_pairs = 0;
+    auto add_pair = [out, &num_pairs, left_hook, right_hook, special_root, global_max](int64_t a, int64_t b) {
+        if (a == left_hook || a == right_hook) {
+            return;
+        }
+        if constexpr (sign == 1) {
+            if (b == special_root) {
+                out[num_pairs++] = {static_cast<uint32_t>(a), global_max, essential};
+            } else {
+                out[num_pairs++] = {static_cast<uint32_t>(a), static_cast<uint32_t>(b), ordinary};
+            }
+        } else {
+            const auto death = b == special_root ? indexed_persistent_pair::special_root : static_cast<uint32_t>(b);
+            out[num_pairs++] = {static_cast<uint32_t>(a), death, relative};
+        }
+    };
+
+    // An endpoint that is higher than its neighbor gets a hook below it.
+    const bool has_left_hook = sample(0) > sample(1);
+    const bool has_right_hook = sample(n - 1) > sample(n - 2);
+
+    stack.clear();
+    stack.emplace_back(fake_left, fake_left);
+    int64_t A = fake_left;
+    auto visit = [&](int64_t j) {
+        if (is_minimum(j)) {
+            A = j;
+            return;
+        }
+        const auto j_value = value(j);
+        while (j_value > value(stack.back().second)) {
+            const auto [a, b] = stack.back();
+            stack.pop_back();
+            if (value(A) < value(a)) {
+                add_pair(a, b);
+            } else {
+                add_pair(A, b);
+                A = a;
+            }
+        }
+        stack.emplace_back(A, j);
+        if (j == special_root) {
+            add_pair(A, j);
+        }
+    };
+
+    if (has_left_hook) {
+        visit(left_hook);
+    }
+    for (int64_t idx = 0; idx < n; ++idx) {
+        if (types[static_cast<size_t>(idx) * stride + lane] != lane_item::noncritical) {
+            visit(idx);
+        }
+    }
+    if (has_right_hook) {
+        visit(right_hook);
+    }
+    visit(special_root);
+    return num_pairs;
+}
+
+// Compute the diagrams of the lanes `first_lane, ..., first_lane + num_lanes - 1` of `batch`.
+void pair_lanes(const interleaved_series_batch &batch, size_t first_lane, size_t num_lanes,
+                lane_state &state, indexed_persistent_pair* pairs, std::vector<size_t> &num_pairs) {
+    constexpr auto W = interleaved_series_batch::lane_width;
+    const auto n = batch.series_length;
+    const auto stride = batch.num_series;
+
+    // Copy the lanes into a buffer of `W` lanes, such that the classification below
+    // always compares full vectors. Unused lanes repeat the last lane.
+    auto &lane_values = state.values;
+    lane_values.resize(n * W);
+    for (size_t idx = 0; idx < n; ++idx) {
+        const auto* row = batch.values.data() + idx * stride + first_lane;
+        for (size_t lane = 0; lane < W; ++lane) {
+            lane_values[idx * W + lane] = row[std::min(lane, num_lanes - 1)];
+        }
+    }
+
+    // Classify the samples of all lanes with respect to the up-tree.
+    // Endpoints are always critical; the construction turns them into minima or maxima.
+    auto &types = state.types;
+    types.resize(n * W);
+    const auto* v = lane_values.data();
+    for (size_t lane = 0; lane < W; ++lane) {
+        types[lane] = v[lane] < v[W + lane] ? lane_item::minimum : lane_item::maximum;
+        types[(n - 1) * W + lane] = v[(n - 1) * W + lane] < v[(n - 2) * W + lane] ? lane_item::minimum
+                                                                                  : lane_item::maximum;
+    }
+    for (size_t idx = 1; idx + 1 < n; ++idx) {
+        const auto* prev = v + (idx - 1) * W;
+        const auto* current = v + idx * W;
+        const auto* next = v + (idx + 1) * W;
+        auto* type = types.data() + idx * W;
+        for (size_t lane = 0; lane < W; ++lane) {
+            const auto is_min = static_cast<uint8_t>(prev[lane] > current[lane] && next[lane] > current[lane]);
+            const auto is_max = static_cast<uint8_t>(prev[lane] < current[lane] && next[lane] < current[lane]);
+            type[lane] = static_cast<lane_item>(is_min | (is_max << 1));
+        }
+    }
+
+    // Find the global maximum of all lanes.
+    std::array<uint32_t, W> global_max{};
+    for (size_t idx = 1; idx < n; ++idx) {
+        for (size_t lane = 0; lane < W; ++lane) {
+            global_max[lane] = v[idx * W + lane] > v[global_max[lane] * W + lane] ? static_cast<uint32_t>(idx)
+                                                                                   : global_max[lane];
+        }
+    }
+
+    for (size_t lane = 0; lane < num_lanes; ++lane) {
+        auto* out = pairs + (first_lane + lane) * n;
+        auto count = pair_lane<1>(v, W, lane, n, types, state.stack, global_max[lane], out);
+        count += pair_lane<-1>(v, W, lane, n, types, state.stack, 0, out + count);
+        massert(count <= n, "Expected at most one pair per item.");
+        num_pairs[first_lane + lane] = count;
+    }
+}
+
+} // End of anonymous namespace
+
+void bananas::construct_batch(const series_batch &batch, diagram_batch &diagrams, size_t num_threads) {
+    const auto num_series = batch.num_series();
+    massert(num_series == 0 || batch.offsets.front() == 0, "Expected the offsets to start at 0.");
+    massert(num_series == 0 || batch.offsets.back() == batch.values.size(),
+            "Expected the offsets to end at the number of values.");
+
+    // A diagram has at most one pair per item, since each item is the birth of at most one pair.
+    // Each series writes its pairs to the slot of its values; the slots are compacted afterwards.
+    diagrams.pairs.resize(batch.values.size());
+    std::vector<size_t> num_pairs(num_series, 0);
+
+    run_in_chunks<construction_state>(num_series, chunk_size, num_threads,
+                                      [&batch, &diagrams, &num_pairs](construction_state &state,
+                                                                      size_t first, size_t last) {
+        for (auto series = first; series < last; ++series) {
+            const auto begin = batch.offsets[series];
+            const auto end = batch.offsets[series + 1];
+            massert(begin <= end, "Expected the offsets to be non-decreasing.");
+            if (end - begin < 2) {
+                continue;
+            }
+            state.values.assign(batch.values.begin() + begin, batch.values.begin() + end);
+            auto* const the_interval = state.context.new_interval(state.values);
+            num_pairs[series] = write_pairs(*the_interval, diagrams.pairs.data() + begin);
+            massert(num_pairs[series] <= end - begin, "Expected at most one pair per item.");
+            state.context.delete_interval(the_interval);
+        }
+    });
+
+    compact_slots(diagrams, num_pairs, [&batch](size_t series) { return batch.offsets[series]; });
+}
+
+void bananas::construct_diagrams_interleaved(const interleaved_series_batch &batch,
+                                             diagram_batch &diagrams,
+                                             size_t num_threads) {
+    constexpr auto W = interleaved_series_batch::lane_width;
+    const auto num_series = batch.num_series;
+    const auto n = batch.series_length;
+    massert(batch.values.size() == num_series * n, "Expected `num_series * series_length` values.");
+
+    std::vector<size_t> num_pairs(num_series, 0);
+    diagrams.pairs.resize(batch.values.size());
+    if (n >= 2) {
+        run_in_chunks<lane_state>(num_series, W, num_threads,
+                                         [&batch, &diagrams, &num_pairs](lane_state &state,
+                                                                         size_t first, size_t last) {
+            pair_lanes(batch, first, last - first, state, diagrams.pairs.data(), num_pairs);
+        });
+    }
+    compact_slots(diagrams, num_pairs, [n](size_t series) { return series * n; });
+}
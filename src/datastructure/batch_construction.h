@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "datastructure/persistence_diagram.h"
+#include "persistence_defs.h"
+
+namespace bananas {
+
+// Many series stored back to back; series `i` consists of the values
+// with indices `offsets[i]` up to, but excluding, `offsets[i+1]`.
+// `offsets` has one more entry than there are series and starts with 0.
+struct series_batch {
+    std::span<const function_value_type> values;
+    std::span<const size_t> offsets;
+
+    [[nodiscard]] inline size_t num_series() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+};
+
+// Many series of the same length stored interleaved, such that sample `i` of series `s`
+// is `values[i * num_series + s]`, e.g., the channels of a multichannel recording.
+struct interleaved_series_batch {
+    // Number of series whose critical items are classified together
+    constexpr static size_t lane_width = 8;
+
+    std::span<const function_value_type> values;
+    size_t num_series;
+    size_t series_length;
+};
+
+// A persistent pair given by the indices of its birth and death within their series.
+struct indexed_persistent_pair {
+    // The relative pair born at the global maximum dies at the special root of the down-tree,
+    // which doesn't correspond to a sample; its death is given by this index.
+    constexpr static uint32_t special_root = std::numeric_limits<uint32_t>::max();
+
+    uint32_t birth;
+    uint32_t death;
+    persistence_diagram::diagram_type type;
+};
+
+// The persistence diagrams of a `series_batch`, stored back to back like the series;
+// the diagram of series `i` consists of the pairs with indices `offsets[i]` up to, but excluding, `offsets[i+1]`.
+struct diagram_batch {
+    std::vector<indexed_persistent_pair> pairs;
+    std::vector<size_t> offsets;
+};
+
+// Compute the persistence diagrams of all series in `batch` on `num_threads` threads
+// and store them in `diagrams`, replacing its contents. `num_threads == 0` uses one thread per core.
+//
+// Each thread constructs the banana trees of one series at a time in its own `persistence_context`,
+// such that items, nodes and scratch space are recycled from one series to the next.
+// Series are handed out in small chunks, so threads that get short series take more of them.
+// Series with fewer than two samples have an empty diagram.
+void construct_batch(const series_batch &batch, diagram_batch &diagrams, size_t num_threads = 0);
+
+// Compute the persistence diagrams of all series in `batch` like `construct_batch`, without building banana trees.
+//
+// Groups of `interleaved_series_batch::lane_width` series are processed in lockstep:
+// their critical items are classified with the same comparisons, which the compiler can vectorize,
+// and then each series runs the pairing of the construction loop of `banana_tree::construct_impl` on its own.
+// The diagrams are the same as those computed by `construct_batch`, though their pairs may be in a different order.
+// Series with fewer than two samples have an empty diagram.
+void construct_diagrams_interleaved(const interleaved_series_batch &batch,
+                                    diagram_batch &diagrams,
+                                    size_t num_threads = 0);
+
+}
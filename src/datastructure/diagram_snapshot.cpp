@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <utility>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "algorithms/banana_tree_algorithms.h"
+#include "datastructure/diagram_snapshot.h"
+#include "datastructure/interval.h"
+#include "datastructure/list_item.h"
+#include "datastructure/persistence_diagram.h"
+#include "persistence_defs.h"
+
+using namespace bananas;
+
+//
+// diagram_snapshot
+//
+
+diagram_snapshot::diagram_snapshot(const interval &ival, uint64_t epoch) : epoch(epoch) {
+    map_persistent_pairs(ival.get_up_tree(), ival.get_down_tree(),
+                         [this](const list_item* birth, const list_item* death,
+                                persistence_diagram::diagram_type type) {
+        pairs.push_back({birth->get_interval_order(), birth->value<1>(),
+                         death->get_interval_order(), death->value<1>(),
+                         type});
+    });
+    std::sort(pairs.begin(), pairs.end(), [](const snapshot_pair &a, const snapshot_pair &b) {
+        return a.birth_order < b.birth_order;
+    });
+}
+
+uint64_t diagram_snapshot::get_epoch() const {
+    return epoch;
+}
+
+const std::vector<snapshot_pair>& diagram_snapshot::get_pairs() const {
+    return pairs;
+}
+
+std::optional<snapshot_pair> diagram_snapshot::find_pair(interval_order_type birth_order) const {
+    auto it = std::lower_bound(pairs.begin(), pairs.end(), birth_order,
+                               [](const snapshot_pair &pair, interval_order_type order) {
+        return pair.birth_order < order;
+    });
+    if (it == pairs.end() || it->birth_order != birth_order) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+size_t diagram_snapshot::get_memory_bytes() const {
+    return sizeof(*this) + pairs.capacity() * sizeof(snapshot_pair);
+}
+
+//
+// snapshot_publisher
+//
+
+void snapshot_publisher::publish(const interval &ival) {
+    const auto epoch = next_epoch.load(std::memory_order_relaxed);
+    auto snapshot = std::make_shared<const diagram_snapshot>(ival, epoch);
+    {
+        std::lock_guard lock(mutex);
+        std::swap(current, snapshot);
+    }
+    next_epoch.store(epoch + 1, std::memory_order_release);
+    // The previous snapshot is released here, outside of the lock, unless a reader still holds it.
+}
+
+std::shared_ptr<const diagram_snapshot> snapshot_publisher::acquire() const {
+    std::lock_guard lock(mutex);
+    return current;
+}
+
+uint64_t snapshot_publisher::get_num_published() const {
+    return next_epoch.load(std::memory_order_acquire);
+}
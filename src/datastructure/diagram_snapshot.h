@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "datastructure/persistence_diagram.h"
+#include "persistence_defs.h"
+
+namespace bananas {
+
+class interval;
+
+// A persistent pair given by the orders and values of its birth and death.
+// The relative pair born at the global maximum dies at the special root of the down-tree,
+// which has infinite order.
+struct snapshot_pair {
+    interval_order_type birth_order;
+    function_value_type birth_value;
+    interval_order_type death_order;
+    function_value_type death_value;
+    persistence_diagram::diagram_type type;
+};
+
+// An immutable copy of the persistence diagram of an interval at one point in time.
+// Refers to items only by their orders, so it stays valid while the interval changes or is deleted,
+// and any number of threads may read it concurrently.
+class diagram_snapshot {
+
+public:
+    // Copy the diagram of `ival`; `epoch` identifies the snapshot.
+    diagram_snapshot(const interval &ival, uint64_t epoch);
+
+    [[nodiscard]] uint64_t get_epoch() const;
+    // Returns the pairs ordered by the order of their birth.
+    [[nodiscard]] const std::vector<snapshot_pair>& get_pairs() const;
+    // Returns the pair born at the item with the given order, if any.
+    [[nodiscard]] std::optional<snapshot_pair> find_pair(interval_order_type birth_order) const;
+    // Returns the bytes used by this snapshot.
+    [[nodiscard]] size_t get_memory_bytes() const;
+
+private:
+    uint64_t epoch;
+    std::vector<snapshot_pair> pairs;
+
+};
+
+// Publishes snapshots of the diagram of an interval from one writer thread to any number of reader threads.
+//
+// Readers can't query the interval itself while it is updated, and not even while it isn't,
+// since lookups in splay trees restructure them. Instead, the writer publishes a `diagram_snapshot`
+// after each batch of updates. Publishing replaces the current snapshot without waiting for readers;
+// readers that still hold an older snapshot keep it alive until they release it.
+// The writer and the readers only synchronize to copy the pointer to the current snapshot.
+class snapshot_publisher {
+
+public:
+    // Copy the diagram of `ival` and make it the current snapshot.
+    // Takes time linear in the number of items of `ival`, plus sorting the pairs,
+    // so publishing after every small batch of updates dominates the cost of the updates.
+    // May only be called by the thread that updates the interval, between updates.
+    void publish(const interval &ival);
+
+    // Returns the current snapshot, or `nullptr` if nothing has been published.
+    // May be called by any thread.
+    [[nodiscard]] std::shared_ptr<const diagram_snapshot> acquire() const;
+
+    // Returns the number of published snapshots, which is the epoch of the next snapshot.
+    [[nodiscard]] uint64_t get_num_published() const;
+
+private:
+    // Guards `current`; held only to copy or replace the pointer.
+    mutable std::mutex mutex;
+    std::shared_ptr<const diagram_snapshot> current;
+    std::atomic<uint64_t> next_epoch{0};
+
+};
+
+}
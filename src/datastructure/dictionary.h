@@ -207,6 +207,14 @@ using item_search_tree_type = internal::item_avl_tree;
 using item_search_tree_type = internal::item_splay_tree;
 #endif
 
+// Whether the dictionaries implement `join` and `cut`,
+// which are needed for gluing and cutting intervals.
+#ifdef AVL_SEARCH_TREE
+constexpr bool dictionary_supports_join_and_cut = false;
+#elif defined SPLAY_SEARCH_TREE
+constexpr bool dictionary_supports_join_and_cut = true;
+#endif
+
 enum class item_storage_type {
 minimum = -1,
 non_critical = 0,
@@ -293,6 +301,11 @@ public:
         // `lower_bound` yields an item `i` with `i >= item`.
         // If `item` is in the tree, then `i == item` and we return the previous item.
         // Otherwise, `i > item` and thus `--i < item`.
+        // If `i` is the first item, then no item is less than `item`.
+        if (iter == search_tree.begin()) {
+            DICT_TIME_END(previous);
+            return search_tree.end();
+        }
         --iter;
         DICT_TIME_END(previous);
         return iter;
@@ -0,0 +1,158 @@
+#include <chrono>
+#include <istream>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "datastructure/diagram_snapshot.h"
+#include "datastructure/ingest_pipeline.h"
+#include "datastructure/interval.h"
+#include "datastructure/persistence_context.h"
+#include "persistence_defs.h"
+#include "utility/errors.h"
+#include "utility/timer.h"
+
+using namespace bananas;
+
+double ingest_pipeline::stage_statistics::throughput() const {
+    const auto seconds = std::chrono::duration<double>(busy_time).count();
+    return seconds > 0 ? static_cast<double>(num_values) / seconds : 0;
+}
+
+ingest_pipeline::ingest_pipeline(persistence_context &context) : ingest_pipeline(context, options{}) {}
+
+ingest_pipeline::ingest_pipeline(persistence_context &context, options opts) : context(context), opts(opts) {
+    massert(opts.chunk_size > 0, "Expected chunks to hold at least one value.");
+    massert(opts.chunks_per_snapshot > 0, "Expected snapshots to be published after at least one chunk.");
+    massert(opts.max_chunks_in_flight > 0 && opts.max_chunks_in_flight <= max_queue_size,
+            "Expected the number of chunks in flight to fit into the queues.");
+    chunks.resize(opts.max_chunks_in_flight);
+    for (size_t chunk_idx = 0; chunk_idx < chunks.size(); ++chunk_idx) {
+        chunks[chunk_idx].reserve(opts.chunk_size);
+        free_chunks.try_push(chunk_idx);
+    }
+}
+
+interval* ingest_pipeline::ingest(std::istream &stream) {
+    std::thread parser([this, &stream] { parse(stream); });
+
+    Timer<std::chrono::nanoseconds> timer;
+    // Chunks applied since the last snapshot was published
+    size_t unpublished_chunks = 0;
+    while (true) {
+        size_t chunk_idx;
+        if (!full_chunks.try_pop(chunk_idx)) {
+            timer.restart();
+            while (!full_chunks.try_pop(chunk_idx)) {
+                std::this_thread::yield();
+            }
+            maintenance_statistics.stall_time += timer.elapsed();
+        }
+        if (chunk_idx == end_of_stream) {
+            break;
+        }
+        timer.restart();
+        apply(chunks[chunk_idx]);
+        ++unpublished_chunks;
+        if (opts.publisher != nullptr && the_interval != nullptr && unpublished_chunks >= opts.chunks_per_snapshot) {
+            opts.publisher->publish(*the_interval);
+            unpublished_chunks = 0;
+        }
+        maintenance_statistics.busy_time += timer.elapsed();
+        maintenance_statistics.num_values += chunks[chunk_idx].size();
+        ++maintenance_statistics.num_chunks;
+        free_chunks.try_push(chunk_idx);
+    }
+
+    if (opts.publisher != nullptr && the_interval != nullptr && unpublished_chunks > 0) {
+        timer.restart();
+        opts.publisher->publish(*the_interval);
+        maintenance_statistics.busy_time += timer.elapsed();
+    }
+
+    parser.join();
+    return the_interval;
+}
+
+void ingest_pipeline::parse(std::istream &stream) {
+    Timer<std::chrono::nanoseconds> timer;
+    bool stream_ended = false;
+    while (!stream_ended) {
+        size_t chunk_idx;
+        if (!free_chunks.try_pop(chunk_idx)) {
+            timer.restart();
+            while (!free_chunks.try_pop(chunk_idx)) {
+                std::this_thread::yield();
+            }
+            parser_statistics.stall_time += timer.elapsed();
+        }
+
+        timer.restart();
+        auto &chunk = chunks[chunk_idx];
+        chunk.clear();
+        function_value_type value;
+        while (chunk.size() < opts.chunk_size) {
+            if (!(stream >> value)) {
+                stream_ended = true;
+                break;
+            }
+            if (!has_last_value || value != last_value) {
+                chunk.push_back(value);
+                last_value = value;
+                has_last_value = true;
+            }
+        }
+        parser_statistics.busy_time += timer.elapsed();
+
+        if (chunk.empty()) {
+            free_chunks.try_push(chunk_idx);
+            continue;
+        }
+        parser_statistics.num_values += chunk.size();
+        ++parser_statistics.num_chunks;
+        // The queue has room for all chunks.
+        full_chunks.try_push(chunk_idx);
+    }
+    while (!full_chunks.try_push(end_of_stream)) {
+        std::this_thread::yield();
+    }
+}
+
+void ingest_pipeline::apply(const std::vector<function_value_type> &values) {
+    if (the_interval != nullptr) {
+        the_interval = context.insert_range(the_interval, the_interval->get_right_endpoint(), values);
+        return;
+    }
+    // An interval needs at least two items, so a single value waits for the next chunk.
+    first_values.insert(first_values.end(), values.begin(), values.end());
+    if (first_values.size() >= 2) {
+        the_interval = context.new_interval(first_values);
+        first_values.clear();
+    }
+}
+
+interval* ingest_pipeline::get_interval() const {
+    return the_interval;
+}
+
+const ingest_pipeline::stage_statistics& ingest_pipeline::get_parser_statistics() const {
+    return parser_statistics;
+}
+
+const ingest_pipeline::stage_statistics& ingest_pipeline::get_maintenance_statistics() const {
+    return maintenance_statistics;
+}
+
+void ingest_pipeline::write_statistics(csv_writer &writer) const {
+    writer << std::make_pair("parse_values", parser_statistics.num_values)
+           << std::make_pair("parse_chunks", parser_statistics.num_chunks)
+           << std::make_pair("parse_time", parser_statistics.busy_time)
+           << std::make_pair("parse_stall_time", parser_statistics.stall_time)
+           << std::make_pair("parse_throughput", parser_statistics.throughput())
+           << std::make_pair("apply_values", maintenance_statistics.num_values)
+           << std::make_pair("apply_chunks", maintenance_statistics.num_chunks)
+           << std::make_pair("apply_time", maintenance_statistics.busy_time)
+           << std::make_pair("apply_stall_time", maintenance_statistics.stall_time)
+           << std::make_pair("apply_throughput", maintenance_statistics.throughput());
+}
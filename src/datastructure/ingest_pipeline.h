@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <limits>
+#include <vector>
+
+#include "persistence_defs.h"
+#include "utility/format_util.h"
+#include "utility/spsc_queue.h"
+
+namespace bananas {
+
+class interval;
+class persistence_context;
+class snapshot_publisher;
+
+// Appends a time series read from a stream to an interval of a `persistence_context`,
+// parsing the stream on a separate thread while the calling thread maintains the banana trees.
+//
+// The parser fills chunks of values and hands them to the calling thread, which appends each chunk
+// with `persistence_context::insert_range` and returns the chunk to the parser for reuse.
+// At most `max_chunks_in_flight` chunks exist; if all of them wait to be applied, the parser stalls.
+// This bounds the memory used for parsed values, and a smaller bound makes the parser back off earlier.
+class ingest_pipeline {
+
+public:
+    // The queues between the stages can't hold more chunks than this.
+    constexpr static size_t max_queue_size = 1024;
+
+    struct options {
+        // Number of values per chunk
+        size_t chunk_size = 4096;
+        // Number of chunks that are parsed but not yet applied, or being filled by the parser
+        size_t max_chunks_in_flight = 16;
+        // If given, a snapshot of the diagram is published after every `chunks_per_snapshot` applied chunks
+        // and after the last chunk, such that other threads can query the diagram during ingestion.
+        snapshot_publisher* publisher = nullptr;
+        // Publishing copies the whole diagram, so publishing after every chunk makes ingestion quadratic
+        // in the length of the stream; publish less often for long streams.
+        size_t chunks_per_snapshot = 16;
+    };
+
+    // Throughput of one stage
+    struct stage_statistics {
+        size_t num_values = 0;
+        size_t num_chunks = 0;
+        // Time spent working, i.e., parsing or applying chunks, including publishing snapshots
+        std::chrono::nanoseconds busy_time{0};
+        // Time spent waiting for the other stage
+        std::chrono::nanoseconds stall_time{0};
+
+        // Values per second of busy time
+        [[nodiscard]] double throughput() const;
+    };
+
+    explicit ingest_pipeline(persistence_context &context);
+    ingest_pipeline(persistence_context &context, options opts);
+
+    ingest_pipeline(const ingest_pipeline&) = delete;
+    ingest_pipeline& operator=(const ingest_pipeline&) = delete;
+
+    // Parse whitespace-separated values from `stream` until it ends or fails to parse,
+    // and append them to the interval. A value equal to the previous one is skipped.
+    // Creates the interval once two values have been parsed. Returns the interval,
+    // or `nullptr` if fewer than two values have been parsed so far.
+    interval* ingest(std::istream &stream);
+
+    [[nodiscard]] interval* get_interval() const;
+    [[nodiscard]] const stage_statistics& get_parser_statistics() const;
+    [[nodiscard]] const stage_statistics& get_maintenance_statistics() const;
+
+    // Write the statistics of both stages, where `parse_*` refers to the parser
+    // and `apply_*` to the stage maintaining the banana trees.
+    void write_statistics(csv_writer &writer) const;
+
+private:
+    // Marks the end of the stream in the queue of full chunks
+    constexpr static size_t end_of_stream = std::numeric_limits<size_t>::max();
+
+    persistence_context &context;
+    options opts;
+    interval* the_interval = nullptr;
+    // Values received before the interval exists
+    std::vector<function_value_type> first_values;
+
+    std::vector<std::vector<function_value_type>> chunks;
+    // Indices of chunks that are filled by the parser, in order
+    spsc_queue<size_t, max_queue_size> full_chunks;
+    // Indices of chunks that the parser may fill
+    spsc_queue<size_t, max_queue_size> free_chunks;
+
+    stage_statistics parser_statistics;
+    stage_statistics maintenance_statistics;
+    // The last parsed value, which the next value is compared to
+    function_value_type last_value = 0;
+    bool has_last_value = false;
+
+    // Runs on the parser thread.
+    void parse(std::istream &stream);
+    void apply(const std::vector<function_value_type> &values);
+
+};
+
+}
@@ -0,0 +1,169 @@
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "datastructure/banana_tree.h"
+#include "datastructure/interchange_worker.h"
+#include "persistence_defs.h"
+#include "utility/errors.h"
+#include "utility/stats.h"
+
+using namespace bananas;
+
+namespace {
+
+template<typename batch_type>
+void perform_interchanges(const batch_type &batch) {
+    for (size_t idx = 0; idx < batch.size; ++idx) {
+        batch.interchanges[idx].first->min_interchange_below(batch.interchanges[idx].second);
+    }
+}
+
+}
+
+interchange_worker::interchange_worker() : thread([this] { run(); }) {}
+
+interchange_worker::~interchange_worker() {
+    wait();
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake_up.notify_one();
+    thread.join();
+}
+
+template<int sign>
+interchange_worker::batch_cycle<sign>& interchange_worker::get_batches() {
+    if constexpr (sign == 1) {
+        return up_batches;
+    } else {
+        return down_batches;
+    }
+}
+
+template<int sign>
+    requires sign_integral<decltype(sign), sign>
+void interchange_worker::push(banana_tree_node<sign>* below, banana_tree_node<sign>* above) {
+    auto &cycle = get_batches<sign>();
+    auto &batch = cycle.batches[cycle.filling];
+    batch.interchanges[batch.size++] = {below, above};
+    if (batch.size == batch_size) {
+        hand_off(cycle);
+    }
+}
+
+void interchange_worker::begin_batch() {
+    if (in_batch) {
+        return;
+    }
+    in_batch = true;
+    pushing.store(true, std::memory_order_release);
+    {
+        std::lock_guard lock(mutex);
+        batch_pending = true;
+    }
+    wake_up.notify_one();
+}
+
+template<int sign>
+void interchange_worker::hand_off(batch_cycle<sign> &cycle) {
+    begin_batch();
+    while (!cycle.queue.try_push(&cycle.batches[cycle.filling])) {
+        std::this_thread::yield();
+    }
+    cycle.filling = (cycle.filling + 1) % cycle.batches.size();
+    cycle.batches[cycle.filling].size = 0;
+}
+
+void interchange_worker::execute(void (*new_task)(void*), void* context) {
+    massert(!in_batch, "Expected nothing to be queued when executing a task.");
+    in_batch = true;
+    {
+        std::lock_guard lock(mutex);
+        task = new_task;
+        task_context = context;
+        batch_pending = true;
+    }
+    wake_up.notify_one();
+}
+
+void interchange_worker::wait() {
+    auto &up_batch = up_batches.batches[up_batches.filling];
+    auto &down_batch = down_batches.batches[down_batches.filling];
+    if (!in_batch) {
+        // Too few interchanges to fill a batch, so the thread is still asleep.
+        perform_interchanges(up_batch);
+        perform_interchanges(down_batch);
+        up_batch.size = 0;
+        down_batch.size = 0;
+        return;
+    }
+    // The rest of the interchanges are performed after those handed over before.
+    if (up_batch.size != 0) {
+        hand_off(up_batches);
+    }
+    if (down_batch.size != 0) {
+        hand_off(down_batches);
+    }
+    pushing.store(false, std::memory_order_release);
+    while (!batch_done.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    batch_done.store(false, std::memory_order_relaxed);
+    in_batch = false;
+
+    // The thread has finished and only continues after the next batch is handed over, under `mutex`.
+    thread_statistics::of_this_thread().take(thread_stats);
+}
+
+void interchange_worker::run() {
+    {
+        std::lock_guard lock(mutex);
+        thread_stats = thread_statistics::of_this_thread();
+    }
+    while (true) {
+        void (*current_task)(void*);
+        void* current_context;
+        {
+            std::unique_lock lock(mutex);
+            wake_up.wait(lock, [this] { return batch_pending || stopping; });
+            if (stopping) {
+                return;
+            }
+            batch_pending = false;
+            current_task = std::exchange(task, nullptr);
+            current_context = task_context;
+        }
+        if (current_task != nullptr) {
+            current_task(current_context);
+        }
+        // Read the flag before draining the queues,
+        // such that all batches are handed over before the final round of draining.
+        bool more_to_come = true;
+        while (more_to_come) {
+            more_to_come = pushing.load(std::memory_order_acquire);
+            drain();
+            if (more_to_come) {
+                std::this_thread::yield();
+            }
+        }
+        batch_done.store(true, std::memory_order_release);
+    }
+}
+
+void interchange_worker::drain() {
+    interchange_batch<1>* up_batch;
+    while (up_batches.queue.try_pop(up_batch)) {
+        perform_interchanges(*up_batch);
+    }
+    interchange_batch<-1>* down_batch;
+    while (down_batches.queue.try_pop(down_batch)) {
+        perform_interchanges(*down_batch);
+    }
+}
+
+namespace bananas {
+    template void interchange_worker::push<1>(banana_tree_node<1>*, banana_tree_node<1>*);
+    template void interchange_worker::push<-1>(banana_tree_node<-1>*, banana_tree_node<-1>*);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "datastructure/banana_tree.h"
+#include "utility/spsc_queue.h"
+#include "utility/stats.h"
+
+namespace bananas {
+
+// A thread that performs min-interchanges in one banana tree
+// while a local operation performs the corresponding max-interchanges in the other tree.
+// Apart from the values of items, which don't change during a local operation, the two trees are independent,
+// so both sequences of interchanges can proceed concurrently as long as each is performed in order.
+//
+// Interchanges are queued by a single thread with `push` and are finished after `wait` returns.
+// They are collected into batches of `batch_size` interchanges, and only full batches are handed to the thread.
+// If an operation queues fewer interchanges than that, `wait` performs them on the queueing thread
+// without waking this thread.
+// The same thread may instead hand over a single task with `execute`, e.g., the cut of one of the trees.
+// The thread sleeps while there is nothing to do.
+//
+// The statistics of the interchanges and tasks performed on the thread are added to those of the queueing thread
+// by `wait`, so they are reported like those of a serial operation.
+class interchange_worker {
+
+public:
+    // Number of interchanges handed to the thread at once.
+    // Waking the thread and switching to it costs 5-10us, while an interchange costs 15-20ns,
+    // as measured by `ex_local_maintenance worst-case` with and without `--concurrent-interchanges`,
+    // so the thread only pays off for operations with a few hundred interchanges in the opposite tree.
+    constexpr static size_t batch_size = 256;
+
+    interchange_worker();
+    ~interchange_worker();
+
+    interchange_worker(const interchange_worker&) = delete;
+    interchange_worker& operator=(const interchange_worker&) = delete;
+
+    // Queue the interchange `below->min_interchange_below(above)`.
+    template<int sign>
+        requires sign_integral<decltype(sign), sign>
+    void push(banana_tree_node<sign>* below, banana_tree_node<sign>* above);
+
+    // Run `task()` on the thread. The task is finished after `wait` returns, and `task` has to live until then.
+    // Expects that nothing has been queued since the last call of `wait`.
+    template<typename task_type>
+    void execute(task_type &task) {
+        execute(&run_task<task_type>, &task);
+    }
+
+    // Wait until all queued interchanges, or the task given to `execute`, have been performed.
+    // Returns immediately if nothing has been queued since the last call.
+    void wait();
+
+private:
+    template<int sign>
+    struct interchange_batch {
+        std::array<std::pair<banana_tree_node<sign>*, banana_tree_node<sign>*>, batch_size> interchanges;
+        size_t size = 0;
+    };
+
+    // Number of full batches that may wait for the thread
+    constexpr static size_t queue_capacity = 4;
+
+    // The batches of one tree. While the queue is full, one more batch is being filled
+    // and one is being performed by the thread, so the batches are reused in a cycle of `queue_capacity + 2`.
+    template<int sign>
+    struct batch_cycle {
+        std::array<interchange_batch<sign>, queue_capacity + 2> batches;
+        spsc_queue<interchange_batch<sign>*, queue_capacity> queue;
+        // Index of the batch being filled; only used by the queueing thread
+        size_t filling = 0;
+    };
+
+    batch_cycle<1> up_batches;
+    batch_cycle<-1> down_batches;
+
+    std::mutex mutex;
+    std::condition_variable wake_up;
+    // Set under `mutex` when the first batch is handed over, or to stop the thread.
+    bool batch_pending = false;
+    bool stopping = false;
+    // The task given to `execute`, or `nullptr`; set under `mutex` and reset by the thread.
+    // A function pointer and the task's address, so that handing over a task doesn't allocate.
+    void (*task)(void*) = nullptr;
+    void* task_context = nullptr;
+    // Whether further batches may be handed over
+    std::atomic<bool> pushing{false};
+    // Set by the thread after performing the last batch
+    std::atomic<bool> batch_done{false};
+    // Whether batches or a task have been handed over since the last call of `wait`; only used by the queueing thread
+    bool in_batch = false;
+
+    // The statistics of the thread, set when it starts.
+    // Only accessed by the queueing thread while the thread waits for work.
+    thread_statistics thread_stats;
+
+    std::thread thread;
+
+    template<typename task_type>
+    static void run_task(void* task) {
+        (*static_cast<task_type*>(task))();
+    }
+    void execute(void (*new_task)(void*), void* context);
+
+    template<int sign>
+    batch_cycle<sign>& get_batches();
+    // Wake up the thread unless it has been woken up since the last call of `wait`.
+    void begin_batch();
+    // Hand the batch being filled to the thread and start filling the next one.
+    template<int sign>
+    void hand_off(batch_cycle<sign> &cycle);
+
+    void run();
+    // Perform all batches handed to the thread.
+    void drain();
+
+};
+
+}
@@ -16,14 +16,16 @@
 using namespace bananas;
 
 interval::interval(recycling_object_pool<up_tree_node> & up_tree_node_pool,
-                   recycling_object_pool<down_tree_node> &down_tree_node_pool) :
-        persistence(up_tree_node_pool, down_tree_node_pool) {}
+                   recycling_object_pool<down_tree_node> &down_tree_node_pool,
+                   persistence_scratch_space* scratch) :
+        persistence(up_tree_node_pool, down_tree_node_pool, scratch) {}
 
 interval::interval(recycling_object_pool<up_tree_node> & up_tree_node_pool,
                    recycling_object_pool<down_tree_node> &down_tree_node_pool,
                    list_item* left_endpoint,
-                   list_item* right_endpoint) :
-        persistence(up_tree_node_pool, down_tree_node_pool),
+                   list_item* right_endpoint,
+                   persistence_scratch_space* scratch) :
+        persistence(up_tree_node_pool, down_tree_node_pool, scratch),
         left_endpoint(left_endpoint),
         right_endpoint(right_endpoint) {
     construct(left_endpoint, right_endpoint);
@@ -31,10 +33,12 @@ interval::interval(recycling_object_pool<up_tree_node> & up_tree_node_pool,
 
 interval::interval(recycling_object_pool<up_tree_node> & up_tree_node_pool,
                    recycling_object_pool<down_tree_node> &down_tree_node_pool,
-                   std::pair<list_item*, list_item*> endpoints) : interval(up_tree_node_pool,
-                                                                           down_tree_node_pool,
-                                                                           endpoints.first,
-                                                                           endpoints.second) {}
+                   std::pair<list_item*, list_item*> endpoints,
+                   persistence_scratch_space* scratch) : interval(up_tree_node_pool,
+                                                                  down_tree_node_pool,
+                                                                  endpoints.first,
+                                                                  endpoints.second,
+                                                                  scratch) {}
 
 interval::interval(interval&& ival) : persistence(std::move(ival.persistence)),
                                       interval_stats(std::move(ival.interval_stats)),
@@ -116,23 +120,8 @@ list_item* interval::insert_item(interval_order_type order, recycling_object_poo
             "Expected to insert a non-endpoint item.");
 
     auto new_item = item_pool.construct(order, 0.0);
-    auto prev_min_it = min_dict.previous_item(*new_item);
-    auto prev_max_it = max_dict.previous_item(*new_item);
-    auto prev_nc_it = nc_dict.previous_item(*new_item);
-    massert(prev_min_it != min_dict.end() || prev_max_it != max_dict.end() || prev_nc_it != nc_dict.end(),
-            "Expected an item in one of the three dictionaries.");
-    auto prev_min_order = prev_min_it == min_dict.end() ? -std::numeric_limits<interval_order_type>::infinity() : prev_min_it->get_interval_order();
-    auto prev_max_order = prev_max_it == max_dict.end() ? -std::numeric_limits<interval_order_type>::infinity() : prev_max_it->get_interval_order();
-    auto prev_nc_order =  prev_nc_it == nc_dict.end()  ? -std::numeric_limits<interval_order_type>::infinity() : prev_nc_it->get_interval_order();
-
-    list_item* left_neighbor_item = nullptr;
-    if (prev_nc_order > prev_min_order && prev_nc_order > prev_max_order) {
-        left_neighbor_item = &*prev_nc_it;
-    } else if (prev_min_order > prev_nc_order && prev_min_order > prev_max_order) {
-        left_neighbor_item = &*prev_min_it;
-    } else {
-        left_neighbor_item = &*prev_max_it;
-    }
+    auto* left_neighbor_item = item_before(order);
+    massert(left_neighbor_item != nullptr, "Expected an item in one of the three dictionaries.");
     auto* right_neighbor_item = left_neighbor_item->right_neighbor();
     left_neighbor_item->cut_right();
     list_item::link(*left_neighbor_item, *new_item);
@@ -156,21 +145,83 @@ list_item* interval::insert_item_to_right_of(list_item* item, recycling_object_p
     return new_item;
 }
 
+list_item* interval::item_before(interval_order_type order) {
+    // Every item is in exactly one of the dictionaries,
+    // so the item we're looking for is the greatest of the three predecessors.
+    const list_item probe{order, 0.0};
+    auto prev_min_it = min_dict.previous_item(probe);
+    auto prev_max_it = max_dict.previous_item(probe);
+    auto prev_nc_it = nc_dict.previous_item(probe);
+    auto prev_min_order = prev_min_it == min_dict.end() ? -std::numeric_limits<interval_order_type>::infinity() : prev_min_it->get_interval_order();
+    auto prev_max_order = prev_max_it == max_dict.end() ? -std::numeric_limits<interval_order_type>::infinity() : prev_max_it->get_interval_order();
+    auto prev_nc_order =  prev_nc_it == nc_dict.end()  ? -std::numeric_limits<interval_order_type>::infinity() : prev_nc_it->get_interval_order();
+
+    if (prev_min_it == min_dict.end() && prev_max_it == max_dict.end() && prev_nc_it == nc_dict.end()) {
+        return nullptr;
+    }
+    if (prev_nc_order > prev_min_order && prev_nc_order > prev_max_order) {
+        return &*prev_nc_it;
+    } else if (prev_min_order > prev_nc_order && prev_min_order > prev_max_order) {
+        return &*prev_min_it;
+    }
+    return &*prev_max_it;
+}
+
+list_item* interval::find_item(interval_order_type order) {
+    auto* item = first_item_not_before(order);
+    if (item == nullptr || item->get_interval_order() != order) {
+        return nullptr;
+    }
+    return item;
+}
+
+list_item* interval::find_nearest_item(interval_order_type order) {
+    auto* right_item = first_item_not_before(order);
+    if (right_item == nullptr) {
+        return right_endpoint;
+    }
+    auto* left_item = right_item->left_neighbor();
+    if (right_item->get_interval_order() == order || left_item == nullptr) {
+        return right_item;
+    }
+    if (order - left_item->get_interval_order() <= right_item->get_interval_order() - order) {
+        return left_item;
+    }
+    return right_item;
+}
+
+list_item* interval::first_item_not_before(interval_order_type order) {
+    if (order <= left_endpoint->get_interval_order()) {
+        return left_endpoint;
+    }
+    return item_before(order)->right_neighbor();
+}
+
 list_item* interval::insert_right_endpoint(function_value_type value, interval_order_type offset, recycling_object_pool<list_item> &item_pool) {
-    return insert_endpoint_impl<false>(value, offset, item_pool);
+    return insert_endpoint_impl<false>(value, right_endpoint->get_interval_order() + offset, item_pool);
 }
 
 list_item* interval::insert_left_endpoint(function_value_type value, interval_order_type offset, recycling_object_pool<list_item> &item_pool) {
-    return insert_endpoint_impl<true>(value, -offset, item_pool);
+    return insert_endpoint_impl<true>(value, left_endpoint->get_interval_order() - offset, item_pool);
+}
+
+list_item* interval::insert_right_endpoint_at(function_value_type value, interval_order_type order, recycling_object_pool<list_item> &item_pool) {
+    massert(order > right_endpoint->get_interval_order(), "Expected the new right endpoint to be right of the old one.");
+    return insert_endpoint_impl<false>(value, order, item_pool);
+}
+
+list_item* interval::insert_left_endpoint_at(function_value_type value, interval_order_type order, recycling_object_pool<list_item> &item_pool) {
+    massert(order < left_endpoint->get_interval_order(), "Expected the new left endpoint to be left of the old one.");
+    return insert_endpoint_impl<true>(value, order, item_pool);
 }
 
 template<bool insert_left>
-list_item* interval::insert_endpoint_impl(function_value_type value, interval_order_type offset, recycling_object_pool<list_item> &item_pool) {
+list_item* interval::insert_endpoint_impl(function_value_type value, interval_order_type order, recycling_object_pool<list_item> &item_pool) {
     auto* old_endpoint = insert_left ? left_endpoint : right_endpoint;
     auto old_endpoint_value = old_endpoint->value<1>();
     auto was_down = old_endpoint->is_down_type<1>();
     auto temp_value = was_down ? add_tiniest_offset<1>(old_endpoint_value) : add_tiniest_offset<-1>(old_endpoint_value);
-    auto new_item = item_pool.construct(old_endpoint->get_interval_order() + offset, temp_value);
+    auto new_item = item_pool.construct(order, temp_value);
     if constexpr (insert_left) {
         list_item::link(*new_item, *old_endpoint);
     } else {
@@ -447,6 +498,18 @@ void interval::decrease_maximum(list_item* item, function_value_type value) {
     }
 }
 
+void interval::update_value_of_two_endpoints(list_item* item, function_value_type value) {
+    // There is no internal item that the local operations could slide the minimum or maximum to
+    // if `item` passes the value of the other endpoint, so construct the trees of the two items anew.
+    auto* up_type_endpoint = left_endpoint->is_up_type<1>() ? left_endpoint : right_endpoint;
+    auto* down_type_endpoint = up_type_endpoint == left_endpoint ? right_endpoint : left_endpoint;
+    min_dict.erase_item(*up_type_endpoint);
+    max_dict.erase_item(*down_type_endpoint);
+    persistence.clear();
+    item->assign_value(value);
+    construct(left_endpoint, right_endpoint);
+}
+
 void interval::update_value_of_endpoint(list_item* item, function_value_type value) {
     massert(item->is_endpoint(),
             "Changing value of an endpoint, but the given item isn't an endpoint.");
@@ -454,6 +517,10 @@ void interval::update_value_of_endpoint(list_item* item, function_value_type val
     auto is_left = item->is_left_endpoint();
     auto* neighbor_item = is_left ? item->right_neighbor() :
                                    item->left_neighbor();
+    if (neighbor_item->is_endpoint()) {
+        update_value_of_two_endpoints(item, value);
+        return;
+    }
     auto neighbor_value = neighbor_item->value<1>();
     if (value_increased) {
         if (item->is_down_type<1>()) {
@@ -710,6 +777,35 @@ void interval::print_statistics(multirow_csv_writer& writer) {
     interval_stats.print(writer);
 }
 
+memory_usage interval::compute_memory_usage() const {
+    constexpr size_t hook_bytes = sizeof(list_item::search_tree_hook);
+    memory_usage usage;
+    size_t num_up_nodes = 0;
+    size_t num_down_nodes = 0;
+    for (const list_item* item = left_endpoint; item != nullptr;
+         item = item == right_endpoint ? nullptr : item->right_neighbor()) {
+        usage.num_items++;
+        num_up_nodes += static_cast<size_t>(item->get_node<1>() != nullptr);
+        num_down_nodes += static_cast<size_t>(item->get_node<-1>() != nullptr);
+    }
+    // The items of the special roots and the hooks are part of the banana trees,
+    // but their nodes are allocated like any other.
+    auto count_tree_nodes = [](const auto &tree) {
+        return static_cast<size_t>(tree.get_special_root() != nullptr) +
+               static_cast<size_t>(tree.get_left_hook() != nullptr) +
+               static_cast<size_t>(tree.get_right_hook() != nullptr);
+    };
+    num_up_nodes += count_tree_nodes(get_up_tree());
+    num_down_nodes += count_tree_nodes(get_down_tree());
+
+    usage.list_items = usage.num_items * (sizeof(list_item) - hook_bytes);
+    usage.dictionary_hooks = usage.num_items * hook_bytes;
+    usage.up_nodes = num_up_nodes * sizeof(up_tree_node);
+    usage.down_nodes = num_down_nodes * sizeof(down_tree_node);
+    usage.intervals = sizeof(interval);
+    return usage;
+}
+
 void interval::analyze_banana_trees() {
     using up_node_t = const up_tree_node*;
     using down_node_t = const down_tree_node*;
@@ -911,7 +1007,7 @@ bool bananas::operator!=(const interval_critical_iterator &a, const interval_cri
 
 
 
-interval_id_t interval_statistics::next_interval_id = 0;
+std::atomic<interval_id_t> interval_statistics::next_interval_id{0};
 
 void interval_statistics::print(multirow_csv_writer& writer) {
     writer << std::make_pair("id", interval_id)
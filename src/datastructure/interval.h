@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <concepts>
 #include <cstddef>
 #include <iterator>
@@ -14,6 +15,7 @@
 #include "datastructure/persistence_diagram.h"
 #include "persistence_defs.h"
 #include "utility/format_util.h"
+#include "utility/memory_usage.h"
 #include "utility/recycling_object_pool.h"
 #include "utility/stats.h"
 
@@ -80,8 +82,7 @@ public:
         dist_count
     };
 
-    inline interval_statistics() : interval_id(next_interval_id) {
-        next_interval_id++;
+    inline interval_statistics() : interval_id(next_interval_id.fetch_add(1, std::memory_order_relaxed)) {
         reset();
     }
 
@@ -101,7 +102,8 @@ public:
     }
 
 private:
-    static interval_id_t next_interval_id;
+    // Shared by all contexts, which may be used from different threads
+    static std::atomic<interval_id_t> next_interval_id;
 
     interval_id_t interval_id;
 
@@ -155,15 +157,19 @@ public:
 
 
 
+    // If `scratch` is given, the banana trees use it instead of allocating temporary memory for cuts and constructions.
     interval(recycling_object_pool<up_tree_node> &up_tree_node_pool,
-             recycling_object_pool<down_tree_node> &down_tree_node_pool);
+             recycling_object_pool<down_tree_node> &down_tree_node_pool,
+             persistence_scratch_space* scratch = nullptr);
     interval(recycling_object_pool<up_tree_node> &up_tree_node_pool,
              recycling_object_pool<down_tree_node> &down_tree_node_pool,
              list_item* left_endpoint,
-             list_item* right_endpoint);
+             list_item* right_endpoint,
+             persistence_scratch_space* scratch = nullptr);
     interval(recycling_object_pool<up_tree_node> &up_tree_node_pool,
              recycling_object_pool<down_tree_node> &down_tree_node_pool,
-             std::pair<list_item*, list_item*> endpoints);
+             std::pair<list_item*, list_item*> endpoints,
+             persistence_scratch_space* scratch = nullptr);
 
     interval(const interval&) = delete;
 
@@ -189,18 +195,33 @@ public:
     // are obtained by interpolation between its two neighbors.
     list_item* insert_item_to_right_of(list_item* item, recycling_object_pool<list_item> &item_pool);
 
+    // Returns the item with the greatest order that is less than `order`,
+    // or `nullptr` if no item has order less than `order`.
+    // Uses the dictionaries instead of walking the list of items.
+    list_item* item_before(interval_order_type order);
+    // Returns the item with the given order, or `nullptr` if there is no such item.
+    list_item* find_item(interval_order_type order);
+    // Returns the item whose order is closest to `order`.
+    // Ties are broken in favor of the item with smaller order.
+    list_item* find_nearest_item(interval_order_type order);
+
     // Insert a new right endpoint with the given function value
     // The order of the new endpoint is that of the old endpoint plus the offset.
     list_item* insert_right_endpoint(function_value_type value, interval_order_type offset, recycling_object_pool<list_item> &item_pool);
     // Insert a new left endpoint with the given function value
     // The order of the new endpoint is that of the old endpoint minus the offset.
     list_item* insert_left_endpoint(function_value_type value, interval_order_type offset, recycling_object_pool<list_item> &item_pool);
+    // Insert a new right endpoint with the given function value and exactly the given order,
+    // which has to be greater than the order of the old right endpoint.
+    list_item* insert_right_endpoint_at(function_value_type value, interval_order_type order, recycling_object_pool<list_item> &item_pool);
+    // Insert a new left endpoint with the given function value and exactly the given order,
+    // which has to be less than the order of the old left endpoint.
+    list_item* insert_left_endpoint_at(function_value_type value, interval_order_type order, recycling_object_pool<list_item> &item_pool);
 
 private: 
-    // Insert a new endpoint (left endpoint if `left == true`, right endpoint otherwise) with the given `value`.
-    // The order of the new endpoint is the order of the old endpoint plus the offset (offset is always added independent of the template parameter).
+    // Insert a new endpoint (left endpoint if `left == true`, right endpoint otherwise) with the given `value` and `order`.
     template<bool left>
-    list_item* insert_endpoint_impl(function_value_type value, interval_order_type offset, recycling_object_pool<list_item> &item_pool);
+    list_item* insert_endpoint_impl(function_value_type value, interval_order_type order, recycling_object_pool<list_item> &item_pool);
 
 public:
     // Delete the given non-endpoint item.
@@ -276,6 +297,10 @@ public:
 
     void print_statistics(multirow_csv_writer& writer);
 
+    // Returns the bytes used by the items, nodes and dictionaries of this interval.
+    // Scratch space and item handles are shared by the intervals of a context and are not included.
+    [[nodiscard]] memory_usage compute_memory_usage() const;
+
 private:
     void analyze_banana_trees();
     
@@ -296,6 +321,9 @@ private:
     // Note: `min_dict`, `max_dict`, `nc_dict` need to be initialized separately.
     interval(persistence_data_structure &&pds);
 
+    // Returns the first item whose order is at least `order`, or `nullptr` if there is no such item.
+    list_item* first_item_not_before(interval_order_type order);
+
     void update_non_critical_value(list_item* item, function_value_type value);
 
     // Increase the value of `item` to the given value until `item` becomes critical.
@@ -311,6 +339,8 @@ private:
     void decrease_maximum(list_item* item, function_value_type value);
 
     void update_value_of_endpoint(list_item* item, function_value_type value);
+    // Set the value of endpoint `item` of an interval that consists of its two endpoints only.
+    void update_value_of_two_endpoints(list_item* item, function_value_type value);
 
     // Move critical items that become non-critical upon gluing from `min_dict`/`max_dict` to `nc_dict`.
     // `endpoint_l` and `endpoint_r` are the "inner" endpoints of the left and right interval, respectively,
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "datastructure/list_item.h"
+#include "utility/errors.h"
+
+namespace bananas {
+
+// A handle to a `list_item` that stays safe to hold after the item is deleted.
+// The handle refers to a slot in an `item_handle_table`;
+// deleting the item bumps the slot's generation, so resolving an old handle yields `nullptr`
+// even if the item's memory is recycled for a new item.
+struct item_handle {
+    uint32_t index = list_item::no_handle_index;
+    uint32_t generation = 0;
+
+    friend bool operator==(const item_handle &a, const item_handle &b) = default;
+};
+
+// Maps handles to items in constant time.
+// Slots of deleted items are reused for new handles.
+class item_handle_table {
+
+public:
+    // Returns the handle of `item`, registering the item if it doesn't have a handle yet.
+    item_handle acquire(list_item &item) {
+        if (item.get_handle_index() != list_item::no_handle_index) {
+            return {item.get_handle_index(), slots[item.get_handle_index()].generation};
+        }
+        uint32_t index;
+        if (free_slots.empty()) {
+            massert(slots.size() < list_item::no_handle_index, "Ran out of item handles.");
+            index = static_cast<uint32_t>(slots.size());
+            slots.push_back({nullptr, 0});
+        } else {
+            index = free_slots.back();
+            free_slots.pop_back();
+        }
+        slots[index].item = &item;
+        item.assign_handle_index(index);
+        return {index, slots[index].generation};
+    }
+
+    // Invalidate the handle of `item`, if it has one.
+    // Has to be called before `item` is deleted.
+    void release(list_item &item) {
+        const auto index = item.get_handle_index();
+        if (index == list_item::no_handle_index) {
+            return;
+        }
+        slots[index].item = nullptr;
+        slots[index].generation++;
+        free_slots.push_back(index);
+        item.assign_handle_index(list_item::no_handle_index);
+    }
+
+    // Returns the item referred to by `handle`, or `nullptr` if the item has been deleted.
+    list_item* resolve(const item_handle &handle) const {
+        if (handle.index >= slots.size() || slots[handle.index].generation != handle.generation) {
+            return nullptr;
+        }
+        return slots[handle.index].item;
+    }
+
+    // Returns the number of items that currently have a handle.
+    size_t get_num_handles() const {
+        return slots.size() - free_slots.size();
+    }
+
+    // Returns the number of slots, including those of deleted items.
+    size_t get_num_slots() const {
+        return slots.size();
+    }
+
+    // Returns the number of bytes allocated for slots.
+    size_t get_memory_bytes() const {
+        return slots.capacity() * sizeof(slot) + free_slots.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    struct slot {
+        list_item* item;
+        uint32_t generation;
+    };
+
+    std::vector<slot> slots;
+    std::vector<uint32_t> free_slots;
+
+};
+
+}
@@ -12,8 +12,10 @@ list_item::list_item(const interval_order_type &x_order,
 list_item::list_item(list_item &&other) :
     neighbors(std::move(other.neighbors)),
     order(std::move(other.order)),
-    function_value(std::move(other.order))
+    function_value(std::move(other.function_value))
 {
+    // The slot of a handle points to the item, which doesn't know the table to repoint it.
+    massert(other.handle_index == no_handle_index, "Items with a handle must not be moved.");
     if (other.up_node != nullptr) {
         other.up_node->replace_item(this);
     }
@@ -167,6 +169,14 @@ void list_item::interpolate_neighbors() {
     function_value = (left_value + right_value)/2.0;
 }
 
+uint32_t list_item::get_handle_index() const {
+    return handle_index;
+}
+
+void list_item::assign_handle_index(uint32_t index) {
+    handle_index = index;
+}
+
 template<int sign>
     requires sign_integral<decltype(sign), sign>
 void list_item::assign_node(banana_tree_node<sign> *node) {
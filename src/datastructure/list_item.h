@@ -1,6 +1,8 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
+#include <limits>
 
 #include "persistence_defs.h"
 
@@ -21,6 +23,9 @@ namespace bananas {
             constexpr static size_t left_idx = 0;
             constexpr static size_t right_idx = 1;
 
+            // Handle index of items that are not registered in an `item_handle_table`.
+            constexpr static uint32_t no_handle_index = std::numeric_limits<uint32_t>::max();
+
             inline constexpr static direction other_side(const direction side) {
                 return static_cast<direction>(1 - static_cast<unsigned>(side));
             }
@@ -37,6 +42,8 @@ namespace bananas {
 
             list_item(const list_item&) = delete;
 
+            // Moves the nodes of `other` to this item. Only hooks and special roots are moved, with their banana trees,
+            // and they never have a handle, which the move would leave pointing to `other`.
             list_item(list_item &&other);
         
             [[nodiscard]] list_item_ptr left_neighbor() const;
@@ -108,6 +115,11 @@ namespace bananas {
                 requires sign_integral<decltype(sign), sign>
             banana_tree_node<sign>* get_node() const;
 
+            // Index of this item's slot in the `item_handle_table` of its context,
+            // or `no_handle_index` if no handle has been requested for this item.
+            [[nodiscard]] uint32_t get_handle_index() const;
+            void assign_handle_index(uint32_t index);
+
             // Test if item `q` lies in the interval delimited by `a` and `b`.
             // If `a < b`, returns true if $q \in (a,b)$;
             // if `a > b`, returns true if $q \in (b,a)$.`
@@ -125,6 +137,8 @@ namespace bananas {
             banana_tree_node<1>* up_node = nullptr;
             banana_tree_node<-1>* down_node = nullptr;
 
+            uint32_t handle_index = no_handle_index;
+
             // Comparison by interval order
             friend bool operator<(const list_item& a, const list_item& b);
             friend bool operator<=(const list_item& a, const list_item& b);
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <vector>
+
+#include "datastructure/interval.h"
+#include "datastructure/multi_window_context.h"
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
+#include "persistence_defs.h"
+#include "utility/errors.h"
+#include "utility/format_util.h"
+
+using namespace bananas;
+
+multi_window_context::multi_window_context(const std::vector<size_t> &window_sizes) :
+        window_sizes(window_sizes),
+        windows(window_sizes.size(), nullptr) {
+    massert(!window_sizes.empty(), "Expected at least one window.");
+    massert(std::ranges::all_of(window_sizes, [](size_t size) { return size >= 2; }),
+            "A window needs to contain at least two items.");
+}
+
+void multi_window_context::push_value(function_value_type value) {
+    ++num_samples;
+
+    // Windows are created as soon as there are two samples;
+    // afterwards every sample is appended to each window,
+    // and the oldest sample is dropped from windows that have reached their size.
+    if (num_samples < 2) {
+        first_value = value;
+        return;
+    }
+    const interval_order_type order_of_value = static_cast<interval_order_type>(num_samples - 1);
+    for (size_t idx = 0; idx < windows.size(); ++idx) {
+        if (windows[idx] == nullptr) {
+            windows[idx] = context.new_interval({first_value, value}, std::nullopt, order_of_value - 1);
+            continue;
+        }
+        context.insert_right_endpoint(windows[idx], 1, value);
+        if (num_samples > window_sizes[idx]) {
+            context.delete_left_endpoint(windows[idx]);
+        }
+    }
+}
+
+size_t multi_window_context::get_num_windows() const {
+    return windows.size();
+}
+
+size_t multi_window_context::get_window_size(size_t window_idx) const {
+    return window_sizes[window_idx];
+}
+
+size_t multi_window_context::get_num_items(size_t window_idx) const {
+    return std::min(num_samples, window_sizes[window_idx]);
+}
+
+size_t multi_window_context::get_num_samples() const {
+    return num_samples;
+}
+
+interval* multi_window_context::get_window(size_t window_idx) const {
+    return windows[window_idx];
+}
+
+void multi_window_context::compute_persistence_diagram(size_t window_idx, persistence_diagram &diagram) const {
+    diagram.clear_diagrams();
+    if (windows[window_idx] != nullptr) {
+        context.compute_persistence_diagram(windows[window_idx], diagram);
+    }
+}
+
+void multi_window_context::compute_persistence_diagrams(std::vector<persistence_diagram> &diagrams) const {
+    diagrams.resize(windows.size());
+    for (size_t idx = 0; idx < windows.size(); ++idx) {
+        compute_persistence_diagram(idx, diagrams[idx]);
+    }
+}
+
+const persistence_context& multi_window_context::get_context() const {
+    return context;
+}
+
+void multi_window_context::print_memory_stats(csv_writer &writer) const {
+    context.print_memory_stats(writer);
+}
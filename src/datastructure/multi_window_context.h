@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
+#include "persistence_defs.h"
+#include "utility/format_util.h"
+
+namespace bananas {
+
+class interval;
+
+// Maintains sliding windows of several lengths over a single stream of values.
+// Each window is an interval of the same `persistence_context`, such that they share its item and node pools,
+// and every sample is appended to each window.
+// The windows don't share items: memory and the time to push a value grow with the sum of the window sizes,
+// as for separate contexts, since the diagram of a window can't be derived from that of a larger window.
+// Expects consecutive values of the stream to be distinct.
+class multi_window_context {
+
+public:
+    // Expects at least one window size and all window sizes to be at least 2.
+    explicit multi_window_context(const std::vector<size_t> &window_sizes);
+
+    // Append `value` to the stream and slide all windows by one sample.
+    // A window that is not yet full grows instead of sliding.
+    void push_value(function_value_type value);
+
+    size_t get_num_windows() const;
+    size_t get_window_size(size_t window_idx) const;
+    // Returns the number of samples currently in the window, which is less than
+    // the window size only while the stream is shorter than the window.
+    size_t get_num_items(size_t window_idx) const;
+    // Returns the number of samples pushed so far.
+    size_t get_num_samples() const;
+
+    // Returns the interval representing the window,
+    // or `nullptr` if fewer than two samples have been pushed.
+    interval* get_window(size_t window_idx) const;
+
+    // Compute the persistence diagram of a single window.
+    void compute_persistence_diagram(size_t window_idx, persistence_diagram &diagram) const;
+    // Compute one persistence diagram per window; `diagrams` is resized to the number of windows.
+    void compute_persistence_diagrams(std::vector<persistence_diagram> &diagrams) const;
+
+    const persistence_context& get_context() const;
+
+    void print_memory_stats(csv_writer &writer) const;
+
+private:
+    persistence_context context;
+
+    std::vector<size_t> window_sizes;
+    std::vector<interval*> windows;
+
+    // The first sample, which starts the windows together with the second one.
+    function_value_type first_value = 0;
+    size_t num_samples = 0;
+
+};
+
+}
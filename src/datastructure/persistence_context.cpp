@@ -1,16 +1,25 @@
+#include <algorithm>
+#include <functional>
 #include <memory>
+#include <span>
+#include <tuple>
 #include <unordered_set>
 #include <utility>
 
 #include "datastructure/banana_tree.h"
+#include "datastructure/dictionary.h"
+#include "datastructure/interchange_worker.h"
 #include "datastructure/interval.h"
+#include "datastructure/item_handle.h"
 #include "datastructure/list_item.h"
 #include "datastructure/persistence_context.h"
 #include "datastructure/persistence_diagram.h"
 #include "persistence_defs.h"
 #include "utility/format_util.h"
+#include "utility/memory_usage.h"
 #include "utility/recycling_object_pool.h"
 #include "utility/stats.h"
+#include "utility/trace.h"
 #include "utility/types.h"
 
 namespace bananas {
@@ -20,32 +29,56 @@ class persistence_context_impl {
 public:
     interval* new_interval(const std::vector<function_value_type> &values, const optional_vector_ref<list_item*> &item_vector,
                            const interval_order_type initial_order) {
-        massert(values.size() >= 2, "An interval needs at least two items");
+        return new_interval_impl(values, item_vector, [initial_order](size_t idx) {
+            return initial_order + static_cast<interval_order_type>(idx);
+        });
+    }
 
-        // Turn the list of values into a list of `list_item`s.
-        auto *left_endpoint = allocate_item(initial_order, values[0]);
-        if (item_vector.has_value()) {
-            item_vector->get().push_back(left_endpoint);
-        }
-        auto *prev_item = left_endpoint;
-        for (size_t idx = 1; idx < values.size(); ++idx) {
-            auto *new_item = allocate_item(initial_order + idx, values[idx]);
-            if (item_vector.has_value()) {
-                item_vector->get().push_back(new_item);
-            }
-            list_item::link(*prev_item, *new_item);
-            prev_item = new_item;
+    interval* new_interval(const std::vector<interval_order_type> &orders, const std::vector<function_value_type> &values,
+                           const optional_vector_ref<list_item*> &item_vector) {
+        massert(orders.size() == values.size(), "Expected one order per value.");
+        massert(std::ranges::adjacent_find(orders, std::greater_equal<>{}) == orders.end(),
+                "Expected strictly increasing orders.");
+        return new_interval_impl(values, item_vector, [&orders](size_t idx) {
+            return orders[idx];
+        });
+    }
+
+    interval* new_interval(const std::vector<function_value_type> &values, std::vector<item_handle> &handles,
+                           const interval_order_type initial_order) {
+        std::vector<list_item*> items;
+        items.reserve(values.size());
+        auto* result = new_interval(values, std::ref(items), initial_order);
+        for (auto* item: items) {
+            handles.push_back(item_handles.acquire(*item));
         }
+        return result;
+    }
 
-        auto* new_interval = interval_pool.construct(up_tree_node_pool, down_tree_node_pool, std::make_pair(left_endpoint, prev_item));
-        interval_ptr_set.insert(new_interval);
-        return new_interval;
+    item_handle get_handle(list_item* item) {
+        massert(item->left_neighbor() != nullptr || item->right_neighbor() != nullptr,
+                "Expected an item of an interval, not a hook or special root.");
+        return item_handles.acquire(*item);
+    }
+
+    list_item* resolve(const item_handle &handle) const {
+        return item_handles.resolve(handle);
     }
 
     void change_value(interval* interval, list_item* item, function_value_type new_value) {
         interval->update_value(item, new_value);
     }
 
+    void set_concurrent_interchanges(bool enable) {
+        scratch_space.worker = enable ? get_worker() : nullptr;
+        release_unused_worker();
+    }
+
+    void set_parallel_cuts(bool enable) {
+        scratch_space.cut_worker = enable ? get_worker() : nullptr;
+        release_unused_worker();
+    }
+
     list_item* insert_item(interval* interval, interval_order_type order) {
         return interval->insert_item(order, list_item_pool);
     }
@@ -58,6 +91,22 @@ public:
     list_item* insert_left_endpoint(interval* interval, interval_order_type order_offset, function_value_type value) {
         return interval->insert_left_endpoint(value, order_offset, list_item_pool);
     }
+    list_item* insert_item(interval* interval, interval_order_type order, function_value_type value) {
+        auto* left_endpoint = interval->get_left_endpoint();
+        auto* right_endpoint = interval->get_right_endpoint();
+        if (order > right_endpoint->get_interval_order()) {
+            return interval->insert_right_endpoint_at(value, order, list_item_pool);
+        }
+        if (order < left_endpoint->get_interval_order()) {
+            return interval->insert_left_endpoint_at(value, order, list_item_pool);
+        }
+        auto* item = interval->find_item(order);
+        if (item == nullptr) {
+            item = interval->insert_item(order, list_item_pool);
+        }
+        interval->update_value(item, value);
+        return item;
+    }
 
     void delete_item(interval* interval, list_item* item) {
         if (item == interval->get_right_endpoint()) {
@@ -67,15 +116,15 @@ public:
         } else {
             interval->delete_internal_item(item);
         }
-        list_item_pool.free(item);
+        free_item(item);
     }
     void delete_right_endpoint(interval* interval) {
         auto* deleted_item = interval->delete_right_endpoint();
-        list_item_pool.free(deleted_item);
+        free_item(deleted_item);
     }
     void delete_left_endpoint(interval* interval) {
         auto* deleted_item = interval->delete_left_endpoint();
-        list_item_pool.free(deleted_item);
+        free_item(deleted_item);
     }
 
     void delete_interval(interval* interval) {
@@ -83,10 +132,143 @@ public:
         interval_pool.free(interval);
         interval_ptr_set.erase(interval);
         for (auto* item_ptr = left_endpoint; item_ptr != nullptr; item_ptr = item_ptr->right_neighbor()) {
-            list_item_pool.free(item_ptr);
+            free_item(item_ptr);
         }
     }
 
+    interval* delete_items_before(interval* interval, interval_order_type order) {
+        auto* last_deleted = interval->item_before(order);
+        if (last_deleted == nullptr) {
+            return interval;
+        }
+        massert(last_deleted->right_neighbor() != nullptr && !last_deleted->right_neighbor()->is_right_endpoint(),
+                "Expected at least two items to remain.");
+        if constexpr (dictionary_supports_join_and_cut) {
+            if (!is_among_first(interval->get_left_endpoint(), last_deleted, cut_deletion_threshold)) {
+                auto [left_interval, right_interval] = cut_interval(interval, last_deleted);
+                delete_interval(left_interval);
+                // Remove the item that the cut inserted as new left endpoint.
+                delete_left_endpoint(right_interval);
+                return right_interval;
+            }
+        }
+        while (interval->get_left_endpoint() != last_deleted) {
+            delete_left_endpoint(interval);
+        }
+        delete_left_endpoint(interval);
+        return interval;
+    }
+
+    interval* delete_range(interval* interval, list_item* first, list_item* last) {
+        massert(*first <= *last, "Expected `first` to not be to the right of `last`.");
+        massert(!(first->is_left_endpoint() && (last->is_right_endpoint() || last->right_neighbor()->is_right_endpoint())) &&
+                !(last->is_right_endpoint() && first->left_neighbor()->is_left_endpoint()),
+                "Expected at least two items to remain.");
+        if (first->is_left_endpoint()) {
+            return delete_items_before(interval, last->right_neighbor()->get_interval_order());
+        }
+        if constexpr (dictionary_supports_join_and_cut) {
+            if (!is_among_first(first, last, cut_deletion_threshold)) {
+                if (last->is_right_endpoint()) {
+                    auto [left_interval, right_interval] = cut_interval(interval, first->left_neighbor());
+                    delete_interval(right_interval);
+                    // Remove the item that the cut inserted as new right endpoint.
+                    delete_right_endpoint(left_interval);
+                    return left_interval;
+                }
+                // Cutting to the right of `last` requires two items to the right of `last`. If `last` is next to the
+                // right endpoint, cut to the left of `last` instead and delete `last` from the remaining short piece,
+                // so that the right endpoint is kept.
+                const bool next_to_right_endpoint = last->right_neighbor()->is_right_endpoint();
+                auto* right_cut_item = next_to_right_endpoint ? last->left_neighbor() : last;
+                auto [left_interval, middle_interval] = cut_interval(interval, first->left_neighbor());
+                auto [removed_interval, right_interval] = cut_interval(middle_interval, right_cut_item);
+                delete_interval(removed_interval);
+                if (next_to_right_endpoint) {
+                    delete_item(right_interval, last);
+                }
+                // Remove the items that the cuts inserted at the boundaries of the remaining parts.
+                auto* left_of_cut = left_interval->get_right_endpoint();
+                auto* right_of_cut = right_interval->get_left_endpoint();
+                glue_intervals(left_interval, right_interval);
+                delete_item(left_interval, left_of_cut);
+                delete_item(left_interval, right_of_cut);
+                return left_interval;
+            }
+        }
+        auto* const end = last->right_neighbor();
+        for (auto* item = first; item != end;) {
+            auto* next = item->right_neighbor();
+            delete_item(interval, item);
+            item = next;
+        }
+        return interval;
+    }
+
+    interval* replace_range(interval* interval, list_item* first, list_item* last,
+                            std::span<const function_value_type> values) {
+        massert(*first <= *last, "Expected `first` to not be to the right of `last`.");
+        if constexpr (dictionary_supports_join_and_cut) {
+            if (values.size() >= cut_replacement_threshold) {
+                return rebuild_range(interval, first, last, values);
+            }
+        }
+        auto* item = first;
+        for (auto value: values) {
+            massert(item != last->right_neighbor(), "Expected one value per item.");
+            change_value(interval, item, value);
+            item = item->right_neighbor();
+        }
+        massert(item == last->right_neighbor(), "Expected one value per item.");
+        return interval;
+    }
+
+    interval* insert_range(interval* interval, list_item* after, std::span<const function_value_type> values,
+                           const optional_vector_ref<list_item*> &item_vector) {
+        if constexpr (dictionary_supports_join_and_cut) {
+            if (values.size() >= cut_insertion_threshold) {
+                if (after->is_right_endpoint()) {
+                    auto* block = new_interval_impl(values, item_vector, [order = after->get_interval_order()](size_t idx) {
+                        return order + static_cast<interval_order_type>(idx + 1);
+                    });
+                    glue_intervals(interval, block);
+                    return interval;
+                }
+                // Cutting to the right of `after` requires two items to the right of `after`.
+                if (!after->right_neighbor()->is_right_endpoint()) {
+                    return splice_block(interval, after, values, item_vector);
+                }
+            }
+        }
+        // Space the new items evenly between `after` and its right neighbor.
+        const bool at_right_endpoint = after->is_right_endpoint();
+        const auto first_order = after->get_interval_order();
+        auto* const right_neighbor = at_right_endpoint ? nullptr : after->right_neighbor();
+        const auto step = at_right_endpoint
+            ? interval_order_type{1}
+            : (right_neighbor->get_interval_order() - first_order) / static_cast<interval_order_type>(values.size() + 1);
+        auto* left_neighbor = after;
+        for (size_t idx = 0; idx < values.size(); ++idx) {
+            const auto order = first_order + step * static_cast<interval_order_type>(idx + 1);
+            // Repeated insertions into the same gap, or large orders, may leave no room between the neighbors.
+            massert(left_neighbor->get_interval_order() < order
+                    && (at_right_endpoint || order < right_neighbor->get_interval_order()),
+                    "Expected the orders of the new items to lie strictly between the orders of their neighbors.");
+            list_item* item;
+            if (at_right_endpoint) {
+                item = interval->insert_right_endpoint_at(values[idx], order, list_item_pool);
+            } else {
+                item = interval->insert_item(order, list_item_pool);
+                interval->update_value(item, values[idx]);
+            }
+            left_neighbor = item;
+            if (item_vector.has_value()) {
+                item_vector->get().push_back(item);
+            }
+        }
+        return interval;
+    }
+
     std::pair<interval*, interval*> cut_interval(interval* interval, list_item* cut_item) {
         massert(!cut_item->is_right_endpoint(), "");
         auto* new_interval = interval_pool.construct(interval->cut(cut_item, list_item_pool));
@@ -98,6 +280,16 @@ public:
         }
     }
 
+    std::vector<interval*> cut_interval_many(interval* ival, std::span<list_item* const> cut_items) {
+        std::vector<list_item*> sorted_cut_items(cut_items.begin(), cut_items.end());
+        std::ranges::sort(sorted_cut_items, [](list_item* a, list_item* b) { return *a < *b; });
+        auto duplicates = std::ranges::unique(sorted_cut_items);
+        sorted_cut_items.erase(duplicates.begin(), duplicates.end());
+        std::vector<interval*> pieces(sorted_cut_items.size() + 1);
+        cut_at_median(ival, sorted_cut_items, pieces);
+        return pieces;
+    }
+
     void glue_intervals(interval* left_interval, interval* right_interval) {
         massert(left_interval != right_interval, "Cannot glue an interval to itself.");
         massert(*(left_interval->get_right_endpoint()) < *(right_interval->get_left_endpoint()),
@@ -106,6 +298,18 @@ public:
         delete_interval(right_interval);
     }
 
+    interval* glue_intervals_many(std::span<interval* const> intervals) {
+        massert(!intervals.empty(), "Expected at least one interval.");
+        std::vector<interval*> pieces(intervals.begin(), intervals.end());
+        // In each round, glue every remaining piece at an even position to its right neighbor.
+        for (size_t stride = 1; stride < pieces.size(); stride *= 2) {
+            for (size_t idx = 0; idx + stride < pieces.size(); idx += 2 * stride) {
+                glue_intervals(pieces[idx], pieces[idx + stride]);
+            }
+        }
+        return pieces.front();
+    }
+
     void compute_persistence_diagram(persistence_diagram &diagram) const {
         diagram.clear_diagrams();
         for (auto* ival: interval_ptr_set) {
@@ -113,11 +317,17 @@ public:
         }
     }
 
+    void compute_persistence_diagram(interval* interval, persistence_diagram &diagram) const {
+        diagram.clear_diagrams();
+        interval->compute_persistence_diagram(diagram);
+    }
+
     void analyse_all_intervals(multirow_csv_writer& writer) const {
         for (auto* interval: interval_ptr_set) {
             writer.new_row();
             interval->compute_statistics();
             interval->print_statistics(writer);
+            interval->compute_memory_usage().write(writer, "mem");
         }
     }
 
@@ -138,7 +348,39 @@ public:
                << std::make_pair("allocs_interval_pool", interval_pool.get_number_of_allocations())
                << std::make_pair("recycled_list_items", list_item_pool.get_number_of_recyclings())
                << std::make_pair("recycled_up_nodes", up_tree_node_pool.get_number_of_recyclings())
-               << std::make_pair("recycled_down_nodes", down_tree_node_pool.get_number_of_recyclings());
+               << std::make_pair("recycled_down_nodes", down_tree_node_pool.get_number_of_recyclings())
+               << std::make_pair("item_handle_slots", item_handles.get_num_slots())
+               << std::make_pair("scratch_uses", scratch_space.up_tree_scratch.number_of_uses +
+                                                 scratch_space.down_tree_scratch.number_of_uses)
+               << std::make_pair("scratch_growths", scratch_space.up_tree_scratch.number_of_growths +
+                                                    scratch_space.down_tree_scratch.number_of_growths);
+        get_memory_usage().write(writer, "mem_live");
+        get_peak_memory_usage().write(writer, "mem_peak");
+        writer << std::make_pair("mem_allocated", get_allocated_memory_bytes());
+    }
+
+    memory_usage get_memory_usage() const {
+        return memory_usage_of(list_item_pool.get_number_of_live_objects(),
+                               up_tree_node_pool.get_number_of_live_objects(),
+                               down_tree_node_pool.get_number_of_live_objects(),
+                               interval_pool.get_number_of_live_objects());
+    }
+
+    memory_usage get_peak_memory_usage() const {
+        return memory_usage_of(list_item_pool.get_peak_number_of_live_objects(),
+                               up_tree_node_pool.get_peak_number_of_live_objects(),
+                               down_tree_node_pool.get_peak_number_of_live_objects(),
+                               interval_pool.get_peak_number_of_live_objects());
+    }
+
+    size_t get_allocated_memory_bytes() const {
+        return list_item_pool.get_allocated_bytes() +
+               up_tree_node_pool.get_allocated_bytes() +
+               down_tree_node_pool.get_allocated_bytes() +
+               interval_pool.get_allocated_bytes() +
+               unordered_container_bytes(interval_ptr_set) +
+               scratch_bytes() +
+               item_handles.get_memory_bytes();
     }
 
 private:
@@ -146,11 +388,202 @@ private:
     recycling_object_pool<banana_tree_node<1>> up_tree_node_pool;
     recycling_object_pool<banana_tree_node<-1>> down_tree_node_pool;
     recycling_object_pool<interval> interval_pool;
+    // Shared by the banana trees of all intervals
+    persistence_scratch_space scratch_space;
+    // Performs interchanges or cuts concurrently if either is enabled, otherwise `nullptr`.
+    // Both use the same worker, since local operations and cuts never overlap.
+    std::unique_ptr<interchange_worker> worker;
 
     std::unordered_set<interval*> interval_ptr_set;
 
+    item_handle_table item_handles;
+
+    // Runs of fewer items than the following thresholds are processed item by item instead of by cutting and gluing.
+    // Each threshold is the measured run length at which both ways take about the same time,
+    // on random values in intervals of 10^3 and 10^5 items.
+    // Deleting fewer than this many consecutive items
+    // is done item by item instead of by cutting the interval.
+    constexpr static size_t cut_deletion_threshold = 40;
+    // Inserting fewer than this many consecutive items
+    // is done item by item instead of by gluing an interval of the new items.
+    constexpr static size_t cut_insertion_threshold = 64;
+    // Replacing the values of fewer than this many consecutive items
+    // is done item by item instead of by constructing the banana trees of the items anew,
+    // which saves less per item than deleting or inserting by cuts.
+    constexpr static size_t cut_replacement_threshold = 256;
+
     // Private methods
 
+    // Returns the bytes used by the given numbers of objects and by the memory shared by all intervals.
+    memory_usage memory_usage_of(size_t num_items, size_t num_up_nodes, size_t num_down_nodes, size_t num_intervals) const {
+        constexpr size_t hook_bytes = sizeof(list_item::search_tree_hook);
+        memory_usage usage;
+        usage.num_items = num_items;
+        usage.list_items = num_items * (sizeof(list_item) - hook_bytes);
+        usage.dictionary_hooks = num_items * hook_bytes;
+        usage.up_nodes = num_up_nodes * sizeof(banana_tree_node<1>);
+        usage.down_nodes = num_down_nodes * sizeof(banana_tree_node<-1>);
+        usage.intervals = num_intervals * sizeof(interval) + unordered_container_bytes(interval_ptr_set, num_intervals);
+        // Scratch space and item handles only grow, so their current size is also their peak size.
+        usage.scratch = scratch_bytes();
+        usage.item_handles = item_handles.get_memory_bytes();
+        return usage;
+    }
+
+    size_t scratch_bytes() const {
+        return scratch_space.up_tree_scratch.get_memory_bytes() + scratch_space.down_tree_scratch.get_memory_bytes();
+    }
+
+    interchange_worker* get_worker() {
+        if (worker == nullptr) {
+            worker = std::make_unique<interchange_worker>();
+        }
+        return worker.get();
+    }
+    // Stop the worker if neither concurrent interchanges nor parallel cuts are enabled.
+    void release_unused_worker() {
+        if (scratch_space.worker == nullptr && scratch_space.cut_worker == nullptr) {
+            worker.reset();
+        }
+    }
+
+    template<typename order_function_type>
+    interval* new_interval_impl(std::span<const function_value_type> values, const optional_vector_ref<list_item*> &item_vector,
+                                const order_function_type &order_of) {
+        massert(values.size() >= 2, "An interval needs at least two items");
+
+        // Turn the list of values into a list of `list_item`s.
+        auto *left_endpoint = allocate_item(order_of(0), values[0]);
+        if (item_vector.has_value()) {
+            item_vector->get().push_back(left_endpoint);
+        }
+        auto *prev_item = left_endpoint;
+        for (size_t idx = 1; idx < values.size(); ++idx) {
+            auto *new_item = allocate_item(order_of(idx), values[idx]);
+            if (item_vector.has_value()) {
+                item_vector->get().push_back(new_item);
+            }
+            list_item::link(*prev_item, *new_item);
+            prev_item = new_item;
+        }
+
+        auto* new_interval = interval_pool.construct(up_tree_node_pool, down_tree_node_pool, std::make_pair(left_endpoint, prev_item),
+                                                    &scratch_space);
+        interval_ptr_set.insert(new_interval);
+        return new_interval;
+    }
+
+    // Helper function for `insert_range`:
+    // Cut `interval` to the right of `after`, construct an interval on `values` that fits
+    // between the items inserted by the cut, and glue the three parts.
+    interval* splice_block(interval* interval, list_item* after, std::span<const function_value_type> values,
+                           const optional_vector_ref<list_item*> &item_vector) {
+        auto [left_interval, right_interval] = cut_interval(interval, after);
+        auto* left_of_cut = left_interval->get_right_endpoint();
+        auto* right_of_cut = right_interval->get_left_endpoint();
+        const auto first_order = left_of_cut->get_interval_order();
+        const auto step = (right_of_cut->get_interval_order() - first_order) / static_cast<interval_order_type>(values.size() + 1);
+        auto* block = new_interval_impl(values, item_vector, [first_order, step](size_t idx) {
+            return first_order + step * static_cast<interval_order_type>(idx + 1);
+        });
+        massert(*left_of_cut < *block->get_left_endpoint() && *block->get_right_endpoint() < *right_of_cut,
+                "Expected the orders of the new items to lie strictly between the orders of their neighbors.");
+        glue_intervals(left_interval, block);
+        glue_intervals(left_interval, right_interval);
+        delete_item(left_interval, left_of_cut);
+        delete_item(left_interval, right_of_cut);
+        return left_interval;
+    }
+
+    // Helper function for `replace_range`:
+    // Cut the items from `first` to `last` out of `ival`, assign `values` to them,
+    // construct an interval on them and glue the parts back together.
+    interval* rebuild_range(interval* ival, list_item* first, list_item* last, std::span<const function_value_type> values) {
+        interval* left_interval = nullptr;
+        interval* right_interval = nullptr;
+        auto* middle_interval = ival;
+        if (!first->is_left_endpoint()) {
+            std::tie(left_interval, middle_interval) = cut_interval(middle_interval, first->left_neighbor());
+        }
+        // Cutting to the right of `last` requires two items to the right of `last`.
+        // Otherwise, the right endpoint is rebuilt along with the range and keeps its value.
+        if (!last->is_right_endpoint() && !last->right_neighbor()->is_right_endpoint()) {
+            std::tie(middle_interval, right_interval) = cut_interval(middle_interval, last);
+        }
+
+        // Destroying the middle interval frees its nodes and empties its dictionaries, but keeps its items.
+        auto* left_endpoint = middle_interval->get_left_endpoint();
+        auto* right_endpoint = middle_interval->get_right_endpoint();
+        interval_pool.free(middle_interval);
+        interval_ptr_set.erase(middle_interval);
+        // The items inserted by the cuts are not needed in the middle interval.
+        if (left_interval != nullptr) {
+            auto* left_of_cut = left_endpoint;
+            left_endpoint = left_of_cut->cut_right();
+            free_item(left_of_cut);
+        }
+        if (right_interval != nullptr) {
+            auto* right_of_cut = right_endpoint;
+            right_endpoint = right_of_cut->cut_left();
+            free_item(right_of_cut);
+        }
+
+        auto* item = first;
+        for (auto value: values) {
+            massert(item != last->right_neighbor(), "Expected one value per item.");
+            item->assign_value(value);
+            item = item->right_neighbor();
+        }
+        massert(item == last->right_neighbor(), "Expected one value per item.");
+        auto* result = interval_pool.construct(up_tree_node_pool, down_tree_node_pool, std::make_pair(left_endpoint, right_endpoint),
+                                              &scratch_space);
+        interval_ptr_set.insert(result);
+
+        // Glue the parts and remove the items that the cuts inserted at the boundaries of the outer parts.
+        if (left_interval != nullptr) {
+            auto* left_of_cut = left_interval->get_right_endpoint();
+            glue_intervals(left_interval, result);
+            result = left_interval;
+            delete_item(result, left_of_cut);
+        }
+        if (right_interval != nullptr) {
+            auto* right_of_cut = right_interval->get_left_endpoint();
+            glue_intervals(result, right_interval);
+            delete_item(result, right_of_cut);
+        }
+        return result;
+    }
+
+    // Helper function for `cut_interval_many`:
+    // Cut `ival` at the median of the sorted `cut_items`, recurse on both pieces
+    // and store the resulting pieces in `pieces` from left to right.
+    void cut_at_median(interval* ival, std::span<list_item* const> cut_items, std::span<interval*> pieces) {
+        if (cut_items.empty()) {
+            pieces[0] = ival;
+            return;
+        }
+        const auto median = cut_items.size() / 2;
+        auto [left_interval, right_interval] = cut_interval(ival, cut_items[median]);
+        cut_at_median(left_interval, cut_items.first(median), pieces.first(median + 1));
+        cut_at_median(right_interval, cut_items.subspan(median + 1), pieces.subspan(median + 1));
+    }
+
+    // Returns whether `to` is one of the first `count` items when walking to the right from `from`.
+    static bool is_among_first(list_item* from, list_item* to, size_t count) {
+        for (size_t step = 0; step < count && from != nullptr; ++step, from = from->right_neighbor()) {
+            if (from == to) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Return `item` to the pool, invalidating its handle.
+    void free_item(list_item* item) {
+        item_handles.release(*item);
+        list_item_pool.free(item);
+    }
+
     list_item* allocate_item(const function_value_type &value) {
         return list_item_pool.construct(value);
     }
@@ -171,58 +604,171 @@ persistence_context::~persistence_context() = default;
 interval* persistence_context::new_interval(const std::vector<function_value_type> &values,
                                             const optional_vector_ref<list_item*> &item_vector,
                                             const interval_order_type initial_order) {
+    TRACE_SCOPE("new_interval");
+    LATENCY_SCOPE(construct);
     return pimpl->new_interval(values, item_vector, initial_order);
 }
 
+interval* persistence_context::new_interval(const std::vector<interval_order_type> &orders,
+                                            const std::vector<function_value_type> &values,
+                                            const optional_vector_ref<list_item*> &item_vector) {
+    TRACE_SCOPE("new_interval");
+    LATENCY_SCOPE(construct);
+    return pimpl->new_interval(orders, values, item_vector);
+}
+
+interval* persistence_context::new_interval(const std::vector<function_value_type> &values,
+                                            std::vector<item_handle> &handles,
+                                            const interval_order_type initial_order) {
+    TRACE_SCOPE("new_interval");
+    LATENCY_SCOPE(construct);
+    return pimpl->new_interval(values, handles, initial_order);
+}
+
+item_handle persistence_context::get_handle(list_item* item) {
+    return pimpl->get_handle(item);
+}
+
+list_item* persistence_context::resolve(const item_handle &handle) const {
+    return pimpl->resolve(handle);
+}
+
 void persistence_context::change_value(interval* interval,
                                        list_item* item,
                                        function_value_type new_value) {
+    TRACE_SCOPE("change_value");
+    LATENCY_SCOPE(change_value);
     pimpl->change_value(interval, item, new_value);
 }
 
+void persistence_context::set_concurrent_interchanges(bool enable) {
+    pimpl->set_concurrent_interchanges(enable);
+}
+
+void persistence_context::set_parallel_cuts(bool enable) {
+    pimpl->set_parallel_cuts(enable);
+}
+
 list_item* persistence_context::insert_item(interval* interval, interval_order_type order) {
+    TRACE_SCOPE("insert_item");
+    LATENCY_SCOPE(insert);
     return pimpl->insert_item(interval, order);
 }
 
 list_item* persistence_context::insert_item_right_of(interval* interval, list_item* item) {
+    TRACE_SCOPE("insert_item_right_of");
+    LATENCY_SCOPE(insert);
     return pimpl->insert_item_right_of(interval, item);
 }
 list_item* persistence_context::insert_right_endpoint(interval* interval, interval_order_type order_offset, function_value_type value) {
+    TRACE_SCOPE("insert_right_endpoint");
+    LATENCY_SCOPE(insert);
     return pimpl->insert_right_endpoint(interval, order_offset, value);
 }
 list_item* persistence_context::insert_left_endpoint(interval* interval, interval_order_type order_offset, function_value_type value) {
+    TRACE_SCOPE("insert_left_endpoint");
+    LATENCY_SCOPE(insert);
     return pimpl->insert_left_endpoint(interval, order_offset, value);
 }
 
+list_item* persistence_context::insert_item(interval* interval, interval_order_type order, function_value_type value) {
+    TRACE_SCOPE("insert_item");
+    LATENCY_SCOPE(insert);
+    return pimpl->insert_item(interval, order, value);
+}
+
 void persistence_context::delete_item(interval* interval, list_item* item) {
+    TRACE_SCOPE("delete_item");
+    LATENCY_SCOPE(delete);
     pimpl->delete_item(interval, item);
 }
 
 void persistence_context::delete_right_endpoint(interval* interval) {
+    TRACE_SCOPE("delete_right_endpoint");
+    LATENCY_SCOPE(delete);
     pimpl->delete_right_endpoint(interval);
 }
 
 void persistence_context::delete_left_endpoint(interval* interval) {
+    TRACE_SCOPE("delete_left_endpoint");
+    LATENCY_SCOPE(delete);
     pimpl->delete_left_endpoint(interval);
 }
 
+interval* persistence_context::delete_items_before(interval* interval, interval_order_type order) {
+    TRACE_SCOPE("delete_items_before");
+    return pimpl->delete_items_before(interval, order);
+}
+
+interval* persistence_context::delete_range(interval* interval, list_item* first, list_item* last) {
+    TRACE_SCOPE("delete_range");
+    return pimpl->delete_range(interval, first, last);
+}
+
+interval* persistence_context::replace_range(interval* interval, list_item* first, list_item* last,
+                                             std::span<const function_value_type> values) {
+    TRACE_SCOPE("replace_range");
+    return pimpl->replace_range(interval, first, last, values);
+}
+
+interval* persistence_context::insert_range(interval* interval, list_item* after,
+                                            std::span<const function_value_type> values,
+                                            const optional_vector_ref<list_item*> &item_vector) {
+    TRACE_SCOPE("insert_range");
+    return pimpl->insert_range(interval, after, values, item_vector);
+}
+
+list_item* persistence_context::find_item(interval* interval, interval_order_type order) const {
+    TRACE_SCOPE("find_item");
+    return interval->find_item(order);
+}
+
+list_item* persistence_context::find_nearest_item(interval* interval, interval_order_type order) const {
+    TRACE_SCOPE("find_nearest_item");
+    return interval->find_nearest_item(order);
+}
+
 std::pair<interval*, interval*> persistence_context::cut_interval(interval* interval, list_item* cut_item) {
+    TRACE_SCOPE("cut_interval");
+    LATENCY_SCOPE(cut);
     return pimpl->cut_interval(interval, cut_item);
 }
 
+std::vector<interval*> persistence_context::cut_interval_many(interval* interval, std::span<list_item* const> cut_items) {
+    TRACE_SCOPE("cut_interval_many");
+    return pimpl->cut_interval_many(interval, cut_items);
+}
+
 void persistence_context::glue_intervals(interval* left_interval, interval* right_interval) {
+    TRACE_SCOPE("glue_intervals");
+    LATENCY_SCOPE(glue);
     pimpl->glue_intervals(left_interval, right_interval);
 }
 
+interval* persistence_context::glue_intervals_many(std::span<interval* const> intervals) {
+    TRACE_SCOPE("glue_intervals_many");
+    return pimpl->glue_intervals_many(intervals);
+}
+
 void persistence_context::delete_interval(interval* interval) {
+    TRACE_SCOPE("delete_interval");
     pimpl->delete_interval(interval);
 }
 
 void persistence_context::compute_persistence_diagram(persistence_diagram &diagram) const {
+    TRACE_SCOPE("compute_persistence_diagram");
+    LATENCY_SCOPE(diagram);
     pimpl->compute_persistence_diagram(diagram);
 }
 
+void persistence_context::compute_persistence_diagram(interval* interval, persistence_diagram &diagram) const {
+    TRACE_SCOPE("compute_persistence_diagram");
+    LATENCY_SCOPE(diagram);
+    pimpl->compute_persistence_diagram(interval, diagram);
+}
+
 void persistence_context::analyse_all_intervals(multirow_csv_writer& writer) const {
+    TRACE_SCOPE("analyse_all_intervals");
     pimpl->analyse_all_intervals(writer);
 }
 
@@ -269,6 +815,19 @@ function_value_type persistence_context::get_global_min_value(interval* interval
     return interval->get_down_tree().get_global_max()->value<1>();
 }
 
+memory_usage persistence_context::get_memory_usage() const {
+    return pimpl->get_memory_usage();
+}
+memory_usage persistence_context::get_peak_memory_usage() const {
+    return pimpl->get_peak_memory_usage();
+}
+memory_usage persistence_context::get_memory_usage(interval* interval) const {
+    return interval->compute_memory_usage();
+}
+size_t persistence_context::get_allocated_memory_bytes() const {
+    return pimpl->get_allocated_memory_bytes();
+}
+
 size_t persistence_context::get_num_intervals() const {
     return pimpl->get_num_intervals();
 }
@@ -4,12 +4,15 @@
 #include <memory>
 #include <optional>
 #include <ostream>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "datastructure/item_handle.h"
 #include "datastructure/persistence_diagram.h"
 #include "persistence_defs.h"
 #include "utility/format_util.h"
+#include "utility/memory_usage.h"
 #include "utility/types.h"
 
 namespace bananas {
@@ -19,6 +22,13 @@ class list_item;
 
 class persistence_context_impl;
 
+// Contexts share no state, so different contexts can be used concurrently from different threads.
+// A single context must not be used by several threads at once, not even for different intervals,
+// since all intervals of a context allocate their items and nodes from the same pools,
+// and gluing two intervals requires their trees to share these pools.
+// Intervals that are updated concurrently should thus belong to different contexts,
+// as in `sharded_persistence_context`.
+// Statistics are kept per thread rather than per context.
 class persistence_context {
 
 public:
@@ -28,35 +38,124 @@ public:
     interval* new_interval(const std::vector<function_value_type> &values,
                            const optional_vector_ref<list_item*> &item_vector = std::nullopt,
                            const interval_order_type initial_order = 0);
+    // Create an interval whose items have the given orders and values.
+    // Expects `orders` to be strictly increasing and to have the same length as `values`.
+    interval* new_interval(const std::vector<interval_order_type> &orders,
+                           const std::vector<function_value_type> &values,
+                           const optional_vector_ref<list_item*> &item_vector = std::nullopt);
+    // Create an interval and append a handle to each of its items to `handles`.
+    interval* new_interval(const std::vector<function_value_type> &values,
+                           std::vector<item_handle> &handles,
+                           const interval_order_type initial_order = 0);
+
+    // Returns a handle to `item`, which can be resolved with `resolve` for as long as the item exists.
+    // Expects `item` to be an item of an interval; hooks and special roots of banana trees have no handles.
+    item_handle get_handle(list_item* item);
+    // Returns the item referred to by `handle`, or `nullptr` if the item has been deleted.
+    list_item* resolve(const item_handle &handle) const;
 
     void change_value(interval* interval, list_item* item, function_value_type new_value);
 
+    // If `enable` is true, value changes that cause many interchanges in the banana trees
+    // perform the interchanges in the up-tree and the down-tree concurrently, using a worker thread.
+    // Experimental and disabled by default: on a single core, this was measured slower than the serial path,
+    // 34.4us against 18.2us for `ex_local_maintenance worst-case` on 10^3 items, and no speedup has been measured yet.
+    void set_concurrent_interchanges(bool enable);
+    // If `enable` is true, cutting an interval cuts the up-tree and the down-tree concurrently, using a worker thread.
+    // Disabled by default.
+    void set_parallel_cuts(bool enable);
+
     list_item* insert_item(interval* interval, interval_order_type order);
     list_item* insert_item_right_of(interval* interval, list_item* item);
     list_item* insert_right_endpoint(interval* interval, interval_order_type order_offset, function_value_type value);
     list_item* insert_left_endpoint(interval* interval, interval_order_type order_offset, function_value_type value);
+    // Insert an item with the given order and value at its position in the interval,
+    // which is found with the interval's dictionaries.
+    // Orders outside of the interval yield a new endpoint.
+    // If an item with the given order exists, its value is changed instead.
+    list_item* insert_item(interval* interval, interval_order_type order, function_value_type value);
+    // Insert items with the given values to the right of `after`.
+    // If `after` is not the right endpoint, the new items get evenly spaced orders between those of `after` and its right neighbor,
+    // which have to be far enough apart that these orders are distinct.
+    // Unless only few items are inserted, this constructs an interval on `values` in linear time
+    // and glues it into `interval`.
+    // Appends the new items to `item_vector`, if given.
+    // Returns the interval containing all items, which may be different from `interval`.
+    interval* insert_range(interval* interval, list_item* after, std::span<const function_value_type> values,
+                           const optional_vector_ref<list_item*> &item_vector = std::nullopt);
 
     void delete_item(interval* interval, list_item* item);
     void delete_right_endpoint(interval* interval);
     void delete_left_endpoint(interval* interval);
 
+    // Delete all items with order less than `order`.
+    // Unless only few items are deleted, this cuts the interval once and deletes the left part.
+    // Expects at least two items to remain.
+    // Returns the interval containing the remaining items, which may be different from `interval`.
+    interval* delete_items_before(interval* interval, interval_order_type order);
+    // Delete the items from `first` to `last`, inclusive.
+    // Unless only few items are deleted, this cuts out the items and glues the remaining parts,
+    // which takes time independent of the number of deleted items, apart from freeing them.
+    // Expects at least two items to remain.
+    // Returns the interval containing the remaining items, which may be different from `interval`.
+    interval* delete_range(interval* interval, list_item* first, list_item* last);
+
+    // Replace the values of the items from `first` to `last`, inclusive, by `values`.
+    // The items keep their identities and orders.
+    // Unless only few values are replaced, this cuts out the items, constructs their banana trees anew
+    // and glues the parts back together, instead of changing the values one by one.
+    // Expects one value per item.
+    // Returns the interval containing all items, which may be different from `interval`.
+    interval* replace_range(interval* interval, list_item* first, list_item* last,
+                            std::span<const function_value_type> values);
+
+    // Returns the item of `interval` with the given order, or `nullptr` if there is no such item.
+    // Uses the interval's dictionaries, so the caller doesn't need to keep pointers to items.
+    list_item* find_item(interval* interval, interval_order_type order) const;
+    // Returns the item of `interval` whose order is closest to `order`,
+    // preferring the item with smaller order in case of a tie.
+    list_item* find_nearest_item(interval* interval, interval_order_type order) const;
+
     // Cut the given `interval` to the right of `cut_item`.
     // Returns a pair of interval pointers,
     // where the `first` points to the left interval
     // and `second` points to the right interval.
     std::pair<interval*, interval*> cut_interval(interval* interval, list_item* cut_item);
+    // Cut the given `interval` to the right of each of the `cut_items`, which may be given in any order.
+    // Cuts at the median cut item first and proceeds on both pieces,
+    // so that each cut works on a piece containing a balanced share of the remaining cut items.
+    // Expects each cut item to satisfy the requirements of `cut_interval`.
+    // Returns the pieces ordered from left to right.
+    std::vector<interval*> cut_interval_many(interval* interval, std::span<list_item* const> cut_items);
 
     void glue_intervals(interval* left_interval, interval* right_interval);
+    // Glue the given `intervals`, which are expected to be ordered from left to right.
+    // Glues neighboring pairs in rounds, so that the intervals glued in each round have similar sizes.
+    // Returns the interval containing all items.
+    interval* glue_intervals_many(std::span<interval* const> intervals);
 
     void delete_interval(interval* interval);
 
     void compute_persistence_diagram(persistence_diagram &diagram) const;
+    // Compute the persistence diagram of only the given `interval`.
+    void compute_persistence_diagram(interval* interval, persistence_diagram &diagram) const;
 
     void analyse_all_intervals(multirow_csv_writer& writer) const;
 
     void print_memory_stats(std::ostream &stream) const;
     void print_memory_stats(csv_writer &writer) const;
 
+    // Memory accounting, see `docs/instrumentation.md`.
+    // Returns the bytes used by the live items, nodes and intervals of this context and by its scratch space and item handles.
+    memory_usage get_memory_usage() const;
+    // Returns the largest number of bytes each component has used at any time.
+    // The components may have peaked at different times, so the total is an upper bound on the peak of the total.
+    memory_usage get_peak_memory_usage() const;
+    // Returns the bytes used by the items, nodes and dictionaries of `interval`.
+    memory_usage get_memory_usage(interval* interval) const;
+    // Returns the bytes allocated by this context, including the memory of deleted objects kept for recycling.
+    size_t get_allocated_memory_bytes() const;
+
     // Access to item properties
     bool is_non_critical(list_item* item) const;
     bool is_maximum(list_item* item) const;
@@ -5,6 +5,7 @@
 #include "datastructure/persistence_diagram.h"
 #include "datastructure/list_item.h"
 #include "utility/errors.h"
+#include "utility/memory_usage.h"
 #include "persistence_defs.h"
 
 using namespace bananas;
@@ -83,6 +84,15 @@ bool operator<(const arrow& a, const arrow& b) {
 
 } // End of namespace `detail` 
 
+size_t persistence_diagram::get_memory_bytes() const {
+    return sizeof(*this) +
+           unordered_container_bytes(ordinary_dgm) +
+           unordered_container_bytes(essential_dgm) +
+           unordered_container_bytes(relative_dgm) +
+           unordered_container_bytes(arrow_map) +
+           unordered_container_bytes(birth_pair_map);
+}
+
 persistence_diagram::difference persistence_diagram::symmetric_difference(const persistence_diagram& a, const persistence_diagram &b) {
     std::vector<persistent_pair> points_a;
     points_a.reserve(a.ordinary_dgm.size() + a.essential_dgm.size() + a.relative_dgm.size());
@@ -72,6 +72,9 @@ public:
 
     static difference symmetric_difference(const persistence_diagram& a, const persistence_diagram& b);
 
+    // Returns an estimate of the bytes used by this diagram, see `unordered_container_bytes`.
+    [[nodiscard]] size_t get_memory_bytes() const;
+
 private:
     std::unordered_set<persistent_pair, pair_hash> ordinary_dgm;
     std::unordered_set<persistent_pair, pair_hash> essential_dgm;
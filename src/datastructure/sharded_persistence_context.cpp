@@ -0,0 +1,247 @@
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "datastructure/interval.h"
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
+#include "datastructure/sharded_persistence_context.h"
+#include "persistence_defs.h"
+#include "utility/errors.h"
+#include "utility/stats.h"
+
+using namespace bananas;
+
+sharded_persistence_context::sharded_persistence_context(size_t num_threads, size_t num_shards) {
+    massert(num_threads > 0, "Expected at least one worker.");
+    if (num_shards == 0) {
+        num_shards = 4 * num_threads;
+    }
+    for (size_t shard_idx = 0; shard_idx < num_shards; ++shard_idx) {
+        shards.push_back(std::make_unique<shard>());
+        shards.back()->home_worker = shard_idx % num_threads;
+    }
+    for (size_t worker_idx = 0; worker_idx < num_threads; ++worker_idx) {
+        workers.push_back(std::make_unique<worker>());
+    }
+    // Start the threads only after all workers exist, since they steal from each other.
+    for (size_t worker_idx = 0; worker_idx < num_threads; ++worker_idx) {
+        workers[worker_idx]->thread = std::thread([this, worker_idx] { run(worker_idx); });
+    }
+}
+
+sharded_persistence_context::~sharded_persistence_context() {
+    flush();
+    {
+        std::lock_guard lock(sleep_mutex);
+        stopping = true;
+    }
+    wake_up.notify_all();
+    for (auto &the_worker: workers) {
+        the_worker->thread.join();
+    }
+}
+
+void sharded_persistence_context::append(series_id series, function_value_type value) {
+    submit({operation::operation_type::append, series, 0, value, {}});
+}
+
+void sharded_persistence_context::change_value(series_id series, size_t sample_idx, function_value_type value) {
+    submit({operation::operation_type::change_value, series, sample_idx, value, {}});
+}
+
+void sharded_persistence_context::query(series_id series, query_callback callback) {
+    submit({operation::operation_type::query, series, 0, 0, std::move(callback)});
+}
+
+void sharded_persistence_context::flush() {
+    std::unique_lock lock(sleep_mutex);
+    all_done.wait(lock, [this] { return num_outstanding.load(std::memory_order_acquire) == 0; });
+    lock.unlock();
+
+    // The workers record statistics only while applying operations, which finished before `num_outstanding` dropped to 0.
+    const auto own_statistics = thread_statistics::of_this_thread();
+    for (auto &the_worker: workers) {
+        thread_statistics worker_statistics;
+        {
+            std::lock_guard worker_lock(the_worker->mutex);
+            worker_statistics = the_worker->statistics;
+        }
+        // A worker that hasn't started yet hasn't applied any operations.
+        if (worker_statistics.persistence != nullptr) {
+            own_statistics.take(worker_statistics);
+        }
+    }
+}
+
+size_t sharded_persistence_context::get_num_threads() const {
+    return workers.size();
+}
+
+size_t sharded_persistence_context::get_num_shards() const {
+    return shards.size();
+}
+
+size_t sharded_persistence_context::get_num_steals() const {
+    return num_steals.load(std::memory_order_relaxed);
+}
+
+//
+// Scheduling
+//
+
+size_t sharded_persistence_context::shard_index(series_id series) const {
+    return std::hash<series_id>()(series) % shards.size();
+}
+
+void sharded_persistence_context::submit(operation &&op) {
+    const auto shard_idx = shard_index(op.series);
+    auto &the_shard = *shards[shard_idx];
+    num_outstanding.fetch_add(1, std::memory_order_relaxed);
+    bool needs_scheduling;
+    {
+        std::lock_guard lock(the_shard.mutex);
+        the_shard.pending.push_back(std::move(op));
+        needs_scheduling = !the_shard.scheduled;
+        the_shard.scheduled = true;
+    }
+    if (needs_scheduling) {
+        schedule(shard_idx);
+    }
+}
+
+void sharded_persistence_context::schedule(size_t shard_idx) {
+    auto &home = *workers[shards[shard_idx]->home_worker];
+    {
+        std::lock_guard lock(home.mutex);
+        home.ready_shards.push_back(shard_idx);
+    }
+    num_ready.fetch_add(1, std::memory_order_release);
+    // Lock the mutex such that a worker can't miss the notification
+    // between checking `num_ready` and waiting.
+    {
+        std::lock_guard lock(sleep_mutex);
+    }
+    wake_up.notify_one();
+}
+
+bool sharded_persistence_context::take_shard(size_t worker_idx, size_t &shard_idx) {
+    {
+        auto &own = *workers[worker_idx];
+        std::lock_guard lock(own.mutex);
+        if (!own.ready_shards.empty()) {
+            shard_idx = own.ready_shards.front();
+            own.ready_shards.pop_front();
+            num_ready.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < workers.size(); ++offset) {
+        auto &victim = *workers[(worker_idx + offset) % workers.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.ready_shards.empty()) {
+            shard_idx = victim.ready_shards.back();
+            victim.ready_shards.pop_back();
+            num_ready.fetch_sub(1, std::memory_order_relaxed);
+            num_steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void sharded_persistence_context::run(size_t worker_idx) {
+    {
+        auto &own = *workers[worker_idx];
+        std::lock_guard lock(own.mutex);
+        own.statistics = thread_statistics::of_this_thread();
+    }
+    while (true) {
+        size_t shard_idx;
+        if (take_shard(worker_idx, shard_idx)) {
+            process(shard_idx);
+            continue;
+        }
+        std::unique_lock lock(sleep_mutex);
+        wake_up.wait(lock, [this] { return stopping || num_ready.load(std::memory_order_acquire) > 0; });
+        if (stopping && num_ready.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+void sharded_persistence_context::process(size_t shard_idx) {
+    auto &the_shard = *shards[shard_idx];
+    {
+        std::lock_guard lock(the_shard.mutex);
+        std::swap(the_shard.pending, the_shard.processing);
+    }
+    for (auto &op: the_shard.processing) {
+        apply(the_shard, op);
+    }
+    const auto num_applied = the_shard.processing.size();
+    the_shard.processing.clear();
+
+    // Operations submitted in the meantime are applied after those of other shards.
+    bool has_pending;
+    {
+        std::lock_guard lock(the_shard.mutex);
+        has_pending = !the_shard.pending.empty();
+        the_shard.scheduled = has_pending;
+    }
+    if (has_pending) {
+        schedule(shard_idx);
+    }
+
+    if (num_outstanding.fetch_sub(num_applied, std::memory_order_acq_rel) == num_applied) {
+        std::lock_guard lock(sleep_mutex);
+        all_done.notify_all();
+    }
+}
+
+//
+// Operations on series
+//
+
+void sharded_persistence_context::apply(shard &the_shard, operation &op) {
+    switch (op.type) {
+    case operation::operation_type::append: {
+        auto &data = the_shard.series[op.series];
+        if (data.series_interval != nullptr) {
+            the_shard.context.insert_right_endpoint(data.series_interval, 1, op.value);
+            break;
+        }
+        data.first_values.push_back(op.value);
+        if (data.first_values.size() == min_interval_size) {
+            data.series_interval = the_shard.context.new_interval(data.first_values);
+            data.first_values.clear();
+        }
+        break;
+    }
+    case operation::operation_type::change_value: {
+        auto it = the_shard.series.find(op.series);
+        massert(it != the_shard.series.end(), "Expected the series to exist.");
+        auto &data = it->second;
+        if (data.series_interval == nullptr) {
+            massert(op.sample_idx < data.first_values.size(), "Expected the sample to exist.");
+            data.first_values[op.sample_idx] = op.value;
+        } else {
+            auto* item = the_shard.context.find_item(data.series_interval,
+                                                     static_cast<interval_order_type>(op.sample_idx));
+            massert(item != nullptr, "Expected the sample to exist.");
+            the_shard.context.change_value(data.series_interval, item, op.value);
+        }
+        break;
+    }
+    case operation::operation_type::query: {
+        auto it = the_shard.series.find(op.series);
+        if (it == the_shard.series.end() || it->second.series_interval == nullptr) {
+            break;
+        }
+        persistence_diagram diagram;
+        the_shard.context.compute_persistence_diagram(it->second.series_interval, diagram);
+        op.callback(*it->second.series_interval, diagram);
+        break;
+    }
+    }
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
+#include "persistence_defs.h"
+#include "utility/stats.h"
+
+namespace bananas {
+
+class interval;
+
+// Maintains many independent series, each represented by an interval,
+// and applies operations on them on a pool of worker threads.
+//
+// Series are partitioned into shards, each of which owns a `persistence_context` for its series.
+// A shard is processed by one worker at a time, which applies all operations queued for the shard.
+// Each shard has a home worker that it is scheduled on, such that a series tends to stay in the caches of one core;
+// idle workers steal shards that are waiting for other workers.
+//
+// Operations are submitted by a single thread and are applied asynchronously,
+// in the order of submission for each series.
+// The statistics of the operations are added to those of the submitting thread by `flush`.
+// Expects consecutive values of a series to be distinct.
+class sharded_persistence_context {
+
+public:
+    using series_id = uint64_t;
+    // Called on a worker thread with the interval of a series and its persistence diagram.
+    // The interval must not be modified.
+    using query_callback = std::function<void(interval&, const persistence_diagram&)>;
+
+    // Samples of a series are buffered until there are this many of them, the fewest items of an interval.
+    constexpr static size_t min_interval_size = 2;
+
+    // Start `num_threads` workers. `num_shards == 0` uses four shards per worker,
+    // such that idle workers find shards to steal.
+    explicit sharded_persistence_context(size_t num_threads, size_t num_shards = 0);
+    // Apply all submitted operations and stop the workers.
+    ~sharded_persistence_context();
+
+    sharded_persistence_context(const sharded_persistence_context&) = delete;
+    sharded_persistence_context& operator=(const sharded_persistence_context&) = delete;
+
+    // Append `value` to the series, creating the series if it doesn't exist.
+    void append(series_id series, function_value_type value);
+    // Change the value of the sample with index `sample_idx` of the series.
+    // Expects the sample to have been appended before.
+    void change_value(series_id series, size_t sample_idx, function_value_type value);
+    // Call `callback` with the persistence diagram of the series.
+    // Series with fewer than `min_interval_size` samples are not represented by an interval,
+    // so the callback isn't called for them.
+    void query(series_id series, query_callback callback);
+
+    // Wait until all submitted operations have been applied
+    // and add the statistics of the workers to those of the calling thread.
+    void flush();
+
+    size_t get_num_threads() const;
+    size_t get_num_shards() const;
+    // Returns the number of shards that were processed by a worker other than their home worker.
+    // Only up-to-date after `flush`.
+    size_t get_num_steals() const;
+
+private:
+    struct operation {
+        enum class operation_type { append, change_value, query };
+
+        operation_type type;
+        series_id series;
+        size_t sample_idx;
+        function_value_type value;
+        query_callback callback;
+    };
+
+    struct series_data {
+        // Samples are buffered until there are `min_interval_size` of them.
+        std::vector<function_value_type> first_values;
+        // The order of the item of a sample is the sample's index.
+        interval* series_interval = nullptr;
+    };
+
+    struct shard {
+        // Only accessed by the worker that processes the shard
+        persistence_context context;
+        std::unordered_map<series_id, series_data> series;
+
+        std::mutex mutex;
+        // Operations that have been submitted, but not yet taken by a worker; guarded by `mutex`
+        std::vector<operation> pending;
+        // Operations taken by the worker; swapped with `pending` to reuse the memory of both
+        std::vector<operation> processing;
+        // Whether the shard is waiting in a worker's deque or being processed; guarded by `mutex`
+        bool scheduled = false;
+        size_t home_worker;
+    };
+
+    struct worker {
+        std::mutex mutex;
+        // Shards with pending operations. The worker takes the shard that has waited longest from the front,
+        // thieves take shards from the back; guarded by `mutex`.
+        std::deque<size_t> ready_shards;
+        // The statistics of the thread, set when it starts; guarded by `mutex`.
+        // The statistics themselves are only accessed by `flush` while no operations are outstanding.
+        thread_statistics statistics;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<shard>> shards;
+    std::vector<std::unique_ptr<worker>> workers;
+
+    // Sleeping workers wait on `wake_up`, `flush` waits on `all_done`.
+    std::mutex sleep_mutex;
+    std::condition_variable wake_up;
+    std::condition_variable all_done;
+    bool stopping = false;
+    // Number of shards in the workers' deques
+    std::atomic<size_t> num_ready{0};
+    // Number of submitted operations that have not been applied yet
+    std::atomic<size_t> num_outstanding{0};
+    std::atomic<size_t> num_steals{0};
+
+    void submit(operation &&op);
+    size_t shard_index(series_id series) const;
+
+    void run(size_t worker_idx);
+    // Take a shard from the deque of worker `worker_idx`, or steal one from another worker.
+    // Returns `false` if no shard is ready.
+    bool take_shard(size_t worker_idx, size_t &shard_idx);
+    // Append the shard to the deque of its home worker and wake up a worker.
+    void schedule(size_t shard_idx);
+    // Apply the operations queued for the shard.
+    void process(size_t shard_idx);
+    void apply(shard &the_shard, operation &op);
+
+};
+
+}
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <vector>
+
+#include "datastructure/interval.h"
+#include "datastructure/list_item.h"
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
+#include "datastructure/time_window.h"
+#include "persistence_defs.h"
+#include "utility/errors.h"
+#include "utility/format_util.h"
+
+using namespace bananas;
+
+time_window::time_window(interval_order_type horizon, size_t reorder_buffer_size) :
+        horizon(horizon),
+        reorder_buffer_size(reorder_buffer_size) {
+    massert(horizon > 0, "Expected a positive time horizon.");
+}
+
+void time_window::push_sample(interval_order_type timestamp, function_value_type value) {
+    reorder_buffer.emplace(timestamp, value);
+    while (reorder_buffer.size() > reorder_buffer_size) {
+        release_sample(*reorder_buffer.begin());
+        reorder_buffer.erase(reorder_buffer.begin());
+    }
+}
+
+void time_window::flush() {
+    for (const auto &sample: reorder_buffer) {
+        release_sample(sample);
+    }
+    reorder_buffer.clear();
+}
+
+interval* time_window::get_interval() const {
+    return window;
+}
+
+interval_order_type time_window::get_horizon() const {
+    return horizon;
+}
+
+size_t time_window::get_num_buffered() const {
+    return reorder_buffer.size();
+}
+
+size_t time_window::get_num_late_insertions() const {
+    return num_late_insertions;
+}
+
+size_t time_window::get_num_dropped() const {
+    return num_dropped;
+}
+
+void time_window::compute_persistence_diagram(persistence_diagram &diagram) const {
+    diagram.clear_diagrams();
+    if (window != nullptr) {
+        context.compute_persistence_diagram(window, diagram);
+    }
+}
+
+const persistence_context& time_window::get_context() const {
+    return context;
+}
+
+void time_window::print_statistics(csv_writer &writer) const {
+    writer << std::make_pair("horizon", horizon)
+           << std::make_pair("reorder_buffer_size", reorder_buffer_size)
+           << std::make_pair("late_insertions", num_late_insertions)
+           << std::make_pair("dropped_samples", num_dropped);
+}
+
+void time_window::release_sample(const sample_type &sample) {
+    const auto [timestamp, value] = sample;
+    if (window == nullptr) {
+        // An interval needs two items, so the first sample waits for the second one.
+        if (!first_sample.has_value() || first_sample->first == timestamp) {
+            first_sample = sample;
+            newest_timestamp = timestamp;
+            return;
+        }
+        const auto [older, newer] = std::minmax(*first_sample, sample);
+        window = context.new_interval(std::vector{older.first, newer.first}, std::vector{older.second, newer.second});
+        newest_timestamp = newer.first;
+        first_sample.reset();
+        return;
+    }
+
+    if (timestamp < newest_timestamp - horizon) {
+        ++num_dropped;
+        return;
+    }
+    if (timestamp <= newest_timestamp) {
+        ++num_late_insertions;
+    }
+    context.insert_item(window, timestamp, value);
+    newest_timestamp = std::max(newest_timestamp, timestamp);
+    evict_old_samples();
+}
+
+void time_window::evict_old_samples() {
+    auto* second_newest = window->get_right_endpoint()->left_neighbor();
+    const auto cutoff = std::min(newest_timestamp - horizon, second_newest->get_interval_order());
+    window = context.delete_items_before(window, cutoff);
+}
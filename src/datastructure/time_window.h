@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <utility>
+
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
+#include "persistence_defs.h"
+#include "utility/format_util.h"
+
+namespace bananas {
+
+class interval;
+
+// Maintains the samples of a stream whose timestamps lie within `horizon` of the newest timestamp.
+// Timestamps serve as interval orders.
+// Samples are held back in a reordering buffer of bounded size
+// and are released into the window in order of their timestamps once the buffer is full.
+// A sample that is released after a newer sample is inserted at its position in the window,
+// which takes logarithmic time, instead of forcing a rebuild of the window.
+// The window always keeps its two newest samples, even if they are older than the horizon.
+class time_window {
+
+    using sample_type = std::pair<interval_order_type, function_value_type>;
+
+public:
+    // `reorder_buffer_size` is the number of samples held back; 0 releases every sample immediately.
+    time_window(interval_order_type horizon, size_t reorder_buffer_size);
+
+    // Ingest a sample.
+    // If a sample with the same timestamp is already in the window, its value is replaced.
+    void push_sample(interval_order_type timestamp, function_value_type value);
+
+    // Release all buffered samples into the window.
+    void flush();
+
+    // Returns the interval representing the window,
+    // or `nullptr` if fewer than two samples have been released.
+    interval* get_interval() const;
+
+    interval_order_type get_horizon() const;
+    size_t get_num_buffered() const;
+    // Returns the number of released samples that were not newer than the newest sample in the window.
+    size_t get_num_late_insertions() const;
+    // Returns the number of samples that were older than the horizon when they were released.
+    size_t get_num_dropped() const;
+
+    void compute_persistence_diagram(persistence_diagram &diagram) const;
+
+    const persistence_context& get_context() const;
+
+    void print_statistics(csv_writer &writer) const;
+
+private:
+    persistence_context context;
+    interval* window = nullptr;
+
+    interval_order_type horizon;
+    size_t reorder_buffer_size;
+    // Buffered samples by timestamp; samples with equal timestamps stay in order of arrival.
+    std::multimap<interval_order_type, function_value_type> reorder_buffer;
+
+    // The first released sample, kept until a second sample allows creating the interval.
+    std::optional<sample_type> first_sample;
+    interval_order_type newest_timestamp = 0;
+
+    size_t num_late_insertions = 0;
+    size_t num_dropped = 0;
+
+    void release_sample(const sample_type &sample);
+    void evict_old_samples();
+
+};
+
+}
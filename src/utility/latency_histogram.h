@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace bananas {
+
+// A histogram of non-negative values with logarithmically sized buckets, in the spirit of HDR histograms.
+// Values below `2^sub_bucket_bits` are counted exactly. Larger values share a bucket with values
+// that agree in their `sub_bucket_bits + 1` most significant bits,
+// so a value reported by `value_at_percentile` is at most `2^-sub_bucket_bits` larger than the recorded one.
+// Recording is constant time; histograms can be merged, e.g., those of several threads.
+class latency_histogram {
+
+public:
+    constexpr static int sub_bucket_bits = 4;
+    constexpr static uint64_t sub_bucket_count = uint64_t{1} << sub_bucket_bits;
+    constexpr static size_t num_buckets = (64 - sub_bucket_bits + 1) * sub_bucket_count;
+
+    constexpr void record(uint64_t value) {
+        ++counts[bucket_index(value)];
+        ++total_count;
+        max_value = std::max(max_value, value);
+    }
+
+    // Merging or resetting skips empty histograms, which would otherwise touch all buckets.
+    constexpr void merge(const latency_histogram &other) {
+        if (other.total_count == 0) {
+            return;
+        }
+        for (size_t idx = 0; idx < num_buckets; ++idx) {
+            counts[idx] += other.counts[idx];
+        }
+        total_count += other.total_count;
+        max_value = std::max(max_value, other.max_value);
+    }
+
+    constexpr void reset() {
+        if (total_count == 0) {
+            return;
+        }
+        counts = {};
+        total_count = 0;
+        max_value = 0;
+    }
+
+    [[nodiscard]] constexpr uint64_t get_count() const {
+        return total_count;
+    }
+
+    [[nodiscard]] constexpr uint64_t get_max() const {
+        return max_value;
+    }
+
+    // Returns the smallest value such that at least `percentile` percent of the recorded values are at most this value,
+    // up to the resolution of the buckets. Returns 0 if the histogram is empty.
+    [[nodiscard]] uint64_t value_at_percentile(double percentile) const {
+        if (total_count == 0) {
+            return 0;
+        }
+        const auto rank = std::max(uint64_t{1},
+                                   static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(total_count))));
+        uint64_t seen = 0;
+        for (size_t idx = 0; idx < num_buckets; ++idx) {
+            seen += counts[idx];
+            if (seen >= rank) {
+                return std::min(bucket_upper_bound(idx), max_value);
+            }
+        }
+        return max_value;
+    }
+
+private:
+    constexpr static size_t bucket_index(uint64_t value) {
+        if (value < sub_bucket_count) {
+            return static_cast<size_t>(value);
+        }
+        const int exponent = std::bit_width(value) - 1;
+        const int shift = exponent - sub_bucket_bits;
+        const auto sub_bucket = (value >> shift) & (sub_bucket_count - 1);
+        return static_cast<size_t>((shift + 1) * sub_bucket_count + sub_bucket);
+    }
+
+    // The largest value that falls into the bucket with index `idx`.
+    constexpr static uint64_t bucket_upper_bound(size_t idx) {
+        if (idx < sub_bucket_count) {
+            return idx;
+        }
+        const auto shift = idx / sub_bucket_count - 1;
+        const auto sub_bucket = idx % sub_bucket_count;
+        const auto lower_bound = (sub_bucket_count + sub_bucket) << shift;
+        return lower_bound + ((uint64_t{1} << shift) - 1);
+    }
+
+    std::array<uint64_t, num_buckets> counts = {};
+    uint64_t total_count = 0;
+    uint64_t max_value = 0;
+
+};
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <utility>
+
+namespace bananas {
+
+// Bytes used by the components of the data structure, e.g., of an interval or of all intervals of a context.
+// Persistence diagrams are not part of the data structure and report their bytes themselves.
+// `num_items` is the number of items the bytes are spent on, which gives the bytes per sample.
+struct memory_usage {
+    size_t list_items = 0;
+    // The hooks of the items in the min-, max- and non-critical dictionaries, which are part of the items.
+    size_t dictionary_hooks = 0;
+    size_t up_nodes = 0;
+    size_t down_nodes = 0;
+    // The interval objects, which include the banana trees, the dictionaries and the special roots' items.
+    size_t intervals = 0;
+    size_t scratch = 0;
+    size_t item_handles = 0;
+
+    size_t num_items = 0;
+
+    [[nodiscard]] size_t total() const {
+        return list_items + dictionary_hooks + up_nodes + down_nodes + intervals + scratch + item_handles;
+    }
+
+    [[nodiscard]] double bytes_per_item() const {
+        return num_items == 0 ? 0.0 : static_cast<double>(total()) / static_cast<double>(num_items);
+    }
+
+    memory_usage& operator+=(const memory_usage &other) {
+        list_items += other.list_items;
+        dictionary_hooks += other.dictionary_hooks;
+        up_nodes += other.up_nodes;
+        down_nodes += other.down_nodes;
+        intervals += other.intervals;
+        scratch += other.scratch;
+        item_handles += other.item_handles;
+        num_items += other.num_items;
+        return *this;
+    }
+
+    friend bool operator==(const memory_usage &a, const memory_usage &b) = default;
+
+    // Write the components, the total and the bytes per item, with column names starting with `prefix`.
+    template<typename writer_type>
+    void write(writer_type &writer, const std::string &prefix) const {
+        writer << std::make_pair((prefix + "_list_items").c_str(), list_items)
+               << std::make_pair((prefix + "_dictionary_hooks").c_str(), dictionary_hooks)
+               << std::make_pair((prefix + "_up_nodes").c_str(), up_nodes)
+               << std::make_pair((prefix + "_down_nodes").c_str(), down_nodes)
+               << std::make_pair((prefix + "_intervals").c_str(), intervals)
+               << std::make_pair((prefix + "_scratch").c_str(), scratch)
+               << std::make_pair((prefix + "_item_handles").c_str(), item_handles)
+               << std::make_pair((prefix + "_total").c_str(), total())
+               << std::make_pair((prefix + "_bytes_per_item").c_str(), bytes_per_item());
+    }
+};
+
+// Estimates the bytes allocated by a node-based `std::unordered_set` or `std::unordered_map`:
+// the bucket array and one node per element, holding the element, the pointer to the next node and the cached hash.
+// Allocator overhead is not counted. If `num_elements` is given, it replaces the current number of elements.
+template<typename container_type>
+size_t unordered_container_bytes(const container_type &container, size_t num_elements) {
+    constexpr size_t node_bytes = sizeof(typename container_type::value_type) + sizeof(void*) + sizeof(size_t);
+    return container.bucket_count() * sizeof(void*) + num_elements * node_bytes;
+}
+
+template<typename container_type>
+size_t unordered_container_bytes(const container_type &container) {
+    return unordered_container_bytes(container, container.size());
+}
+
+}
@@ -0,0 +1,98 @@
+#include <array>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "utility/perf_counters.h"
+
+using namespace bananas;
+
+namespace {
+
+struct event_config {
+    uint32_t type;
+    uint64_t config;
+};
+
+constexpr uint64_t cache_miss_config(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+// In the order of `perf_event`.
+constexpr std::array<event_config, num_perf_events> event_configs = {{
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, cache_miss_config(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HW_CACHE, cache_miss_config(PERF_COUNT_HW_CACHE_DTLB)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}
+}};
+
+int open_event(const event_config &event, int group_fd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = event.type;
+    attr.config = event.config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // Count the calling thread on any CPU.
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+}
+
+perf_counter_group::perf_counter_group() {
+    fds.fill(-1);
+    group_position.fill(-1);
+    for (size_t idx = 0; idx < num_perf_events; ++idx) {
+        const auto fd = open_event(event_configs[idx], leader_fd);
+        if (fd < 0) {
+            continue;
+        }
+        if (leader_fd < 0) {
+            leader_fd = fd;
+        }
+        fds[idx] = fd;
+        group_position[idx] = num_open++;
+    }
+}
+
+perf_counter_group::~perf_counter_group() {
+    for (auto fd: fds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+perf_counts perf_counter_group::read() const {
+    perf_counts result;
+    if (num_open == 0) {
+        return result;
+    }
+    // The number of events, the times the group was enabled and running, followed by the values of the events.
+    constexpr size_t header_size = 3;
+    std::array<uint64_t, num_perf_events + header_size> buffer;
+    const auto num_bytes = ::read(leader_fd, buffer.data(), sizeof(buffer));
+    if (num_bytes < static_cast<ssize_t>(header_size * sizeof(uint64_t)) || buffer[0] != static_cast<uint64_t>(num_open)) {
+        return result;
+    }
+    const auto time_enabled = buffer[1];
+    const auto time_running = buffer[2];
+    multiplexed = multiplexed || time_running < time_enabled;
+    for (size_t idx = 0; idx < num_perf_events; ++idx) {
+        if (group_position[idx] >= 0) {
+            result.counts[idx] = scale_multiplexed_count(buffer[static_cast<size_t>(group_position[idx]) + header_size],
+                                                         time_enabled, time_running);
+        }
+    }
+    return result;
+}
+
+perf_counter_group& bananas::thread_perf_counters() {
+    thread_local perf_counter_group counters;
+    return counters;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if !defined(__linux__)
+#error "perf_counters requires Linux."
+#endif
+
+namespace bananas {
+
+// Hardware events counted by `perf_counter_group`.
+enum class perf_event : size_t {
+    cycles,
+    instructions,
+    l1d_misses,
+    llc_misses,
+    dtlb_misses,
+    branch_misses
+};
+
+constexpr size_t num_perf_events = 6;
+
+constexpr std::array<const char*, num_perf_events> perf_event_names = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses", "branch_misses"
+};
+
+// Numbers of events, indexed by `perf_event`.
+struct perf_counts {
+    std::array<int64_t, num_perf_events> counts = {};
+
+    constexpr int64_t operator[](perf_event event) const {
+        return counts[static_cast<size_t>(event)];
+    }
+
+    constexpr perf_counts& operator+=(const perf_counts &other) {
+        for (size_t idx = 0; idx < num_perf_events; ++idx) {
+            counts[idx] += other.counts[idx];
+        }
+        return *this;
+    }
+
+    constexpr perf_counts operator-(const perf_counts &other) const {
+        perf_counts result = *this;
+        for (size_t idx = 0; idx < num_perf_events; ++idx) {
+            result.counts[idx] -= other.counts[idx];
+        }
+        return result;
+    }
+
+    constexpr perf_counts operator*(long factor) const {
+        perf_counts result = *this;
+        for (auto &count: result.counts) {
+            count *= factor;
+        }
+        return result;
+    }
+};
+
+// Estimates the number of events while a group was enabled from the `count` while it was running on a counter.
+// The kernel multiplexes groups if there are more events than counters, so they may run for less time than enabled.
+constexpr int64_t scale_multiplexed_count(uint64_t count, uint64_t time_enabled, uint64_t time_running) {
+    if (time_running == 0) {
+        return 0;
+    }
+    if (time_running >= time_enabled) {
+        return static_cast<int64_t>(count);
+    }
+    return static_cast<int64_t>(static_cast<double>(count) * static_cast<double>(time_enabled) /
+                                static_cast<double>(time_running));
+}
+
+// A group of hardware performance counters of the calling thread, opened with `perf_event_open`.
+// Only events in user space are counted.
+//
+// Events that the kernel refuses to count, e.g., because of `/proc/sys/kernel/perf_event_paranoid`
+// or because the processor doesn't support them, are left out and read as zero.
+// If no event can be counted, reading doesn't make a system call.
+// All events are scheduled together, so their counts refer to the same instructions.
+// If the kernel multiplexes the group with other events, the counts are scaled to the time the group was enabled,
+// see `scale_multiplexed_count`, and `was_multiplexed` returns true.
+class perf_counter_group {
+
+public:
+    perf_counter_group();
+    ~perf_counter_group();
+
+    perf_counter_group(const perf_counter_group&) = delete;
+    perf_counter_group& operator=(const perf_counter_group&) = delete;
+
+    [[nodiscard]] bool is_available(perf_event event) const {
+        return group_position[static_cast<size_t>(event)] >= 0;
+    }
+    [[nodiscard]] bool is_available() const {
+        return num_open > 0;
+    }
+
+    // Whether any read so far found that the group did not run for all the time it was enabled.
+    [[nodiscard]] bool was_multiplexed() const {
+        return multiplexed;
+    }
+
+    // The numbers of events counted since the group was opened.
+    [[nodiscard]] perf_counts read() const;
+
+private:
+    int leader_fd = -1;
+    std::array<int, num_perf_events> fds;
+    // Position of each event in the values read from the group, or -1 if it is not counted.
+    std::array<int, num_perf_events> group_position;
+    int num_open = 0;
+    mutable bool multiplexed = false;
+
+};
+
+// The counters of the calling thread, opened on first use.
+perf_counter_group& thread_perf_counters();
+
+}
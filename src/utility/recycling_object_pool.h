@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <type_traits>
 #include <vector>
 
@@ -33,18 +35,17 @@ public:
     pointer_type construct(Args &&...args) {
         auto size_before = pool.get_next_size();
         if (free_objects.empty()) {
-            auto* result = pool.construct(args...);
-            // Note: counting allocations this way fails if the max size is reached, since then next_size does not change.
-            number_of_allocations += static_cast<int>(size_before != pool.get_next_size());
-            if (size_before != pool.get_next_size()) {
-                DEBUG_MSG("New allocation in memory pool for " << type_to_string<T>() << ".");
-            }
+            // `boost::object_pool::construct` supports only few arguments, so construct in place instead.
+            auto* result = new(pool.malloc()) object_type{args...};
+            count_allocation(size_before);
+            count_live_object();
             return result;
         } 
         // If there is a free object lying around, recycle it.
         number_of_recyclings++;
         auto result = free_objects.back();
         free_objects.pop_back();
+        count_live_object();
         return new(result) object_type{args...};
     }
 
@@ -54,17 +55,15 @@ public:
         if (free_objects.empty()) {
             auto* result = pool.malloc();
             result = new(result) object_type(std::move(temp));
-            // Note: counting allocations this way fails if the max size is reached, since then next_size does not change.
-            number_of_allocations += static_cast<int>(size_before != pool.get_next_size());
-            if (size_before != pool.get_next_size()) {
-                DEBUG_MSG("New allocation in memory pool for " << type_to_string<T>() << ".");
-            }
+            count_allocation(size_before);
+            count_live_object();
             return result;
         } 
         // If there is a free object lying around, recycle it.
         number_of_recyclings++;
         auto result = free_objects.back();
         free_objects.pop_back();
+        count_live_object();
         return new(result) object_type{std::move(temp)};
     }
 
@@ -77,6 +76,7 @@ public:
             ptr->~T();
         }
         free_objects.push_back(ptr);
+        number_of_live_objects--;
     }
 
     int get_number_of_allocations() const {
@@ -87,11 +87,51 @@ public:
         return number_of_recyclings;
     }
 
+    // Returns the number of objects that have been constructed and not freed.
+    size_t get_number_of_live_objects() const {
+        return number_of_live_objects;
+    }
+
+    // Returns the largest number of live objects at any time.
+    size_t get_peak_number_of_live_objects() const {
+        return peak_number_of_live_objects;
+    }
+
+    // Returns the number of objects that fit into the memory allocated by the pool,
+    // including live objects, recycled objects and objects that have not been constructed yet.
+    size_t get_number_of_allocated_objects() const {
+        return number_of_allocated_objects;
+    }
+
+    // Returns the number of bytes allocated for objects, not counting the list of free objects.
+    size_t get_allocated_bytes() const {
+        return number_of_allocated_objects * sizeof(object_type);
+    }
+
 private:
     boost::object_pool<object_type, user_allocator_type> pool;
     std::vector<pointer_type> free_objects;
     int number_of_allocations = 0;
     long number_of_recyclings = 0;
+    size_t number_of_live_objects = 0;
+    size_t peak_number_of_live_objects = 0;
+    size_t number_of_allocated_objects = 0;
+
+    // Count the block allocated by `pool.malloc` if `next_size` was `size_before` before the call.
+    // The pool allocates blocks of `next_size` objects and then doubles `next_size`.
+    // Note: counting allocations this way fails if the max size is reached, since then next_size does not change.
+    void count_allocation(size_t size_before) {
+        if (size_before != pool.get_next_size()) {
+            number_of_allocations++;
+            number_of_allocated_objects += size_before;
+            DEBUG_MSG("New allocation in memory pool for " << type_to_string<T>() << ".");
+        }
+    }
+
+    void count_live_object() {
+        number_of_live_objects++;
+        peak_number_of_live_objects = std::max(peak_number_of_live_objects, number_of_live_objects);
+    }
 
 };
 
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace bananas {
+
+// A bounded queue for exactly one producer thread and one consumer thread.
+// Pushing and popping don't lock; they fail if the queue is full or empty, respectively.
+// `capacity` has to be a power of two.
+template<typename T, size_t capacity>
+class spsc_queue {
+    static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "Expected the capacity to be a power of two.");
+
+public:
+    // Append `value` to the queue. Returns `false` if the queue is full.
+    // May only be called by the producer.
+    bool try_push(const T &value) {
+        const auto tail_idx = tail.load(std::memory_order_relaxed);
+        if (tail_idx - head.load(std::memory_order_acquire) == capacity) {
+            return false;
+        }
+        buffer[tail_idx & (capacity - 1)] = value;
+        tail.store(tail_idx + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Remove the first element of the queue and assign it to `value`. Returns `false` if the queue is empty.
+    // May only be called by the consumer.
+    bool try_pop(T &value) {
+        const auto head_idx = head.load(std::memory_order_relaxed);
+        if (head_idx == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = buffer[head_idx & (capacity - 1)];
+        head.store(head_idx + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<T, capacity> buffer;
+    // Producer and consumer write to different cache lines.
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+
+};
+
+}
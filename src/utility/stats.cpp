@@ -1,21 +1,40 @@
 #include "utility/stats.h"
 #include <chrono>
+#include <limits>
 #include <ostream>
 
+#include "utility/errors.h"
+
 namespace bananas {
 
-persistence_statistics persistence_stats{};
-dictionary_statistics dictionary_stats{};
+constinit thread_local persistence_statistics persistence_stats{};
+constinit thread_local dictionary_statistics dictionary_stats{};
+constinit thread_local latency_statistics latency_stats{};
+std::atomic<bool> latency_recording{false};
 
 namespace time {
 
-clock_type::time_point time_now() {
+std::atomic<long> sampling_period{1};
+std::atomic<uint64_t> sampling_threshold{std::numeric_limits<uint64_t>::max()};
+// Any non-zero seed works for xorshift.
+constinit thread_local uint64_t sampling_state = 0x9e3779b97f4a7c15;
+
+void set_sampling_period(long period) {
+    massert(period >= 1, "Expected a positive sampling period.");
+    sampling_threshold.store(std::numeric_limits<uint64_t>::max() / static_cast<uint64_t>(period),
+                             std::memory_order_relaxed);
+    sampling_period.store(period, std::memory_order_relaxed);
+}
+
+#ifndef USE_TSC_CLOCK
+time_point_type time_now() {
     return clock_type::now();
 }
 
-duration_type time_diff(clock_type::time_point begin, clock_type::time_point end) {
+duration_type time_diff(time_point_type begin, time_point_type end) {
     return std::chrono::duration_cast<duration_type>(end-begin);
 }
+#endif
 
 } // End of namespace time
 
@@ -1,14 +1,25 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <iomanip>
 #include <limits>
 #include <ostream>
+#include <string>
 
 #include "datastructure/banana_tree_sign_template.h"
 #include "persistence_defs.h"
 #include "utility/format_util.h"
+#include "utility/latency_histogram.h"
+#include "utility/trace.h"
+#ifdef USE_PERF_COUNTERS
+#include "utility/perf_counters.h"
+#endif
+#ifdef USE_TSC_CLOCK
+#include "utility/tsc_clock.h"
+#endif
 
 namespace bananas {
 
@@ -20,6 +31,29 @@ constexpr inline size_t sign_to_index(int sign) {
     return (sign + 1) / 2;
 }
 
+#ifdef USE_PERF_COUNTERS
+// Writes one column per event, e.g., `perf_cut_preprocess_cycles_up` and `perf_cut_preprocess_cycles_down`.
+inline void write_perf_counts(csv_writer &writer, const std::string &name, const std::array<perf_counts, 2> &counts) {
+    for (size_t idx = 0; idx < num_perf_events; ++idx) {
+        writer << std::make_pair(("perf_" + name + "_" + perf_event_names[idx]).c_str(),
+                                 std::array<int64_t, 2>{counts[0].counts[idx], counts[1].counts[idx]});
+    }
+}
+// Writes one column per event, e.g., `perf_insert_cycles`.
+inline void write_perf_counts(csv_writer &writer, const std::string &name, const perf_counts &counts) {
+    for (size_t idx = 0; idx < num_perf_events; ++idx) {
+        writer << std::make_pair(("perf_" + name + "_" + perf_event_names[idx]).c_str(), counts.counts[idx]);
+    }
+}
+#endif
+
+// Add the per-sign sums `b` to `a`.
+template<typename T>
+void add_sums(std::array<T, 2> &a, const std::array<T, 2> &b) {
+    a[0] += b[0];
+    a[1] += b[1];
+}
+
 template<int w1, int w2, typename T>
 void write_var_inline(std::ostream& stream, const std::string& name, const std::array<T, 2> &vars) {
     stream << std::setw(w1) << name << ", "
@@ -30,18 +64,97 @@ void write_var_inline(std::ostream& stream, const std::string& name, const std::
 } // End of namespace detail
 
 namespace time {
+#ifdef USE_TSC_CLOCK
+// Timers accumulate ticks of the time-stamp counter, which are only converted when statistics are reported.
+using clock_type = tsc_clock;
+using time_point_type = tsc_clock::tick_point;
+using duration_type = tsc_clock::ticks;
+
+inline time_point_type time_now() {
+    return tsc_clock::read_ticks();
+}
+
+inline duration_type time_diff(time_point_type begin, time_point_type end) {
+    return tsc_clock::elapsed_ticks(begin, end);
+}
+
+inline duration_type scale(duration_type t, long factor) {
+    return {t.count * factor};
+}
+
+inline int64_t to_count(duration_type t) {
+    return t.count;
+}
+
+inline duration_type from_count(int64_t count) {
+    return {count};
+}
+
+template<typename out_duration>
+out_duration to_duration(duration_type t) {
+    return tsc_clock::to_duration<out_duration>(t);
+}
+#else
 using clock_type = std::chrono::high_resolution_clock;
+using time_point_type = clock_type::time_point;
 using duration_type = std::chrono::nanoseconds;
-using duration_rep = duration_type::rep;
 
-clock_type::time_point time_now();
+time_point_type time_now();
+
+duration_type time_diff(time_point_type begin, time_point_type end);
 
-duration_type time_diff(clock_type::time_point begin, clock_type::time_point end);
+inline duration_type scale(duration_type t, long factor) {
+    return t * factor;
+}
+
+inline int64_t to_count(duration_type t) {
+    return t.count();
+}
 
-template<typename out_duration, typename in_duration>
-std::array<out_duration, 2> convert_times(std::array<in_duration, 2> &times) {
-    return {std::chrono::duration_cast<out_duration>(times[0]),
-            std::chrono::duration_cast<out_duration>(times[1])};
+inline duration_type from_count(int64_t count) {
+    return duration_type{count};
+}
+
+template<typename out_duration>
+out_duration to_duration(duration_type t) {
+    return std::chrono::duration_cast<out_duration>(t);
+}
+#endif
+
+template<typename out_duration>
+std::array<out_duration, 2> convert_times(const std::array<duration_type, 2> &times) {
+    return {to_duration<out_duration>(times[0]), to_duration<out_duration>(times[1])};
+}
+
+// Sampling of timers, see `docs/instrumentation.md`.
+// With a sampling period of `n`, each timed phase is timed with probability `1/n` and its time is scaled by `n`,
+// such that the reported times are unbiased estimates of the actual times. Counters still count every operation.
+// The period is shared by all threads; the random numbers are drawn per thread.
+extern std::atomic<long> sampling_period;
+extern std::atomic<uint64_t> sampling_threshold;
+extern constinit thread_local uint64_t sampling_state;
+
+// Set the sampling period; 1 times every phase.
+// Phases that are being timed while the period changes may be scaled by the old period.
+void set_sampling_period(long period);
+
+inline long get_sampling_period() {
+    return sampling_period.load(std::memory_order_relaxed);
+}
+
+// Returns the factor by which the time of the next phase has to be scaled, or 0 if the phase is not timed.
+inline long sample() {
+    const auto period = get_sampling_period();
+    if (period == 1) {
+        return 1;
+    }
+    // xorshift64
+    auto x = sampling_state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    sampling_state = x;
+    return x < sampling_threshold.load(std::memory_order_relaxed) ? period : 0;
 }
 
 }
@@ -88,6 +201,14 @@ std::array<out_duration, 2> convert_times(std::array<in_duration, 2> &times) {
     }
 #define RESET_COUNT_VAR_FUNC(name) \
     void reset_count_##name() { COUNT_VAR(name) = {0, 0}; }
+#define GET_COUNT_FUNC(name) \
+    SIGN_TEMPLATE \
+    detail::count_type get_count_##name() const { \
+        return COUNT_VAR(name)[detail::sign_to_index(sign)]; \
+    }
+#define MERGE_COUNT_VAR_FUNC(name) \
+    template<typename stats_type> \
+    void merge_count_##name(const stats_type &other) { detail::add_sums(COUNT_VAR(name), other.COUNT_VAR(name)); }
 #define RESET_COUNT_MIN_MAX_VAR_FUNC(name) \
     void reset_count_##name() { \
         COUNT_VAR(name) = {0, 0}; \
@@ -123,13 +244,51 @@ std::array<out_duration, 2> convert_times(std::array<in_duration, 2> &times) {
     void time_##name(time::duration_type t) { \
         TIME_VAR(name)[detail::sign_to_index(sign)] += t; \
     }
+#define GET_TIME_FUNC(name) \
+    SIGN_TEMPLATE \
+    time::duration_type get_time_##name() const { \
+        return TIME_VAR(name)[detail::sign_to_index(sign)]; \
+    }
 #define RESET_TIME_FUNC(name) \
-    void reset_time_##name() { TIME_VAR(name) = {time::duration_type{}, time::duration_type{}}; }
+    void reset_time_##name() { \
+        TIME_VAR(name) = {time::duration_type{}, time::duration_type{}}; \
+        RESET_PERF_VAR(name) \
+    }
+#define MERGE_TIME_FUNC(name) \
+    template<typename stats_type> \
+    void merge_time_##name(const stats_type &other) { \
+        detail::add_sums(TIME_VAR(name), other.TIME_VAR(name)); \
+        MERGE_PERF_VAR(name) \
+    }
+
+// With `USE_PERF_COUNTERS`, every timed phase also sums the hardware events counted while it runs.
+#ifdef USE_PERF_COUNTERS
+#define PERF_VAR(name) \
+    perf_##name##_sum
+#define PERF_FUNCTION(name) \
+    SIGN_TEMPLATE \
+    void perf_##name(const perf_counts &counts) { \
+        PERF_VAR(name)[detail::sign_to_index(sign)] += counts; \
+    }
+#define RESET_PERF_VAR(name) \
+    PERF_VAR(name) = {};
+#define MERGE_PERF_VAR(name) \
+    detail::add_sums(PERF_VAR(name), other.PERF_VAR(name));
+#define DEF_PERF_VAR_AND_FUNC(name) \
+    public: PERF_FUNCTION(name) \
+    private: std::array<perf_counts, 2> PERF_VAR(name) = {};
+#else
+#define RESET_PERF_VAR(name)
+#define MERGE_PERF_VAR(name)
+#define DEF_PERF_VAR_AND_FUNC(name)
+#endif
 
 #define DEF_COUNT_VAR_AND_FUNC(name) \
     public: INCREMENT_FUNCTION(name) \
             DECREMENT_FUNCTION(name) \
+            GET_COUNT_FUNC(name) \
             RESET_COUNT_VAR_FUNC(name) \
+            MERGE_COUNT_VAR_FUNC(name) \
     private: std::array<detail::count_type, 2> COUNT_VAR(name) = {0, 0}
 
 #define DEF_COUNT_MIN_MAX_VAR_AND_FUNC(name) \
@@ -152,9 +311,12 @@ std::array<out_duration, 2> convert_times(std::array<in_duration, 2> &times) {
                                                                       std::numeric_limits<detail::count_type>::max()}
 
 #define DEF_TIME_VAR_AND_FUNC(name) \
+    DEF_PERF_VAR_AND_FUNC(name) \
     public: TIME_FUNCTION(name) \
+            GET_TIME_FUNC(name) \
             RESET_TIME_FUNC(name) \
-    private: std::array<time::duration_type, 2> TIME_VAR(name)
+            MERGE_TIME_FUNC(name) \
+    private: std::array<time::duration_type, 2> TIME_VAR(name) = {}
 
 #define PRINT_COUNT_VAR(stream, w1, w2, name) \
     detail::write_var_inline<w1, w2>(stream, #name, COUNT_VAR(name))
@@ -232,7 +394,7 @@ public:
                << std::make_pair("time_max_increase", time::convert_times<duration>(TIME_VAR(max_increase)))
                << std::make_pair("time_max_decrease", time::convert_times<duration>(TIME_VAR(max_decrease)))
                << std::make_pair("time_anticancel_dict",
-                                 std::chrono::duration_cast<duration>(TIME_VAR(anticancellation_dict)[detail::sign_to_index(1)]))
+                                 time::to_duration<duration>(TIME_VAR(anticancellation_dict)[detail::sign_to_index(1)]))
                << std::make_pair("time_do_injury", time::convert_times<duration>(TIME_VAR(do_injury)))
                << std::make_pair("time_do_fatality", time::convert_times<duration>(TIME_VAR(do_fatality)))
                << std::make_pair("time_do_scare", time::convert_times<duration>(TIME_VAR(do_scare)))
@@ -248,6 +410,32 @@ public:
                << std::make_pair("time_construct_prepare", time::convert_times<duration>(TIME_VAR(construct_prepare)))
                << std::make_pair("time_construct_loop", time::convert_times<duration>(TIME_VAR(construct_loop)))
                << std::make_pair("time_construct_cleanup", time::convert_times<duration>(TIME_VAR(construct_cleanup)));
+#ifdef USE_PERF_COUNTERS
+        detail::write_perf_counts(writer, "max_xchange", PERF_VAR(max_interchange));
+        detail::write_perf_counts(writer, "min_xchange", PERF_VAR(min_interchange));
+        detail::write_perf_counts(writer, "min_slide", PERF_VAR(min_slide));
+        detail::write_perf_counts(writer, "max_slide", PERF_VAR(max_slide));
+        detail::write_perf_counts(writer, "cancel", PERF_VAR(cancellation));
+        detail::write_perf_counts(writer, "anticancel", PERF_VAR(anticancellation));
+        detail::write_perf_counts(writer, "max_increase", PERF_VAR(max_increase));
+        detail::write_perf_counts(writer, "max_decrease", PERF_VAR(max_decrease));
+        detail::write_perf_counts(writer, "anticancel_dict", PERF_VAR(anticancellation_dict));
+        detail::write_perf_counts(writer, "do_injury", PERF_VAR(do_injury));
+        detail::write_perf_counts(writer, "do_fatality", PERF_VAR(do_fatality));
+        detail::write_perf_counts(writer, "do_scare", PERF_VAR(do_scare));
+        detail::write_perf_counts(writer, "undo_injury", PERF_VAR(undo_injury));
+        detail::write_perf_counts(writer, "undo_fatality", PERF_VAR(undo_fatality));
+        detail::write_perf_counts(writer, "undo_scare", PERF_VAR(undo_scare));
+        detail::write_perf_counts(writer, "load_stacks", PERF_VAR(load_stacks));
+        detail::write_perf_counts(writer, "cut_preprocess", PERF_VAR(cut_preprocess));
+        detail::write_perf_counts(writer, "cut_postprocess", PERF_VAR(cut_postprocess));
+        detail::write_perf_counts(writer, "glue_preprocess", PERF_VAR(glue_preprocess));
+        detail::write_perf_counts(writer, "glue_postprocess", PERF_VAR(glue_postprocess));
+        detail::write_perf_counts(writer, "construct", PERF_VAR(construct));
+        detail::write_perf_counts(writer, "construct_prepare", PERF_VAR(construct_prepare));
+        detail::write_perf_counts(writer, "construct_loop", PERF_VAR(construct_loop));
+        detail::write_perf_counts(writer, "construct_cleanup", PERF_VAR(construct_cleanup));
+#endif
     }
 
     void reset() {
@@ -289,17 +477,95 @@ public:
         reset_time_construct_loop();
         reset_time_construct_cleanup();
     }
-};
 
-extern persistence_statistics persistence_stats; 
+    // Add the statistics of `other`, e.g., of another thread, to these.
+    void merge(const persistence_statistics &other) {
+        merge_count_max_interchange(other);
+        merge_count_min_interchange(other);
+        merge_count_min_slide(other);
+        merge_count_max_slide(other);
+        merge_count_cancellation(other);
+        merge_count_anticancellation(other);
+        merge_count_anticancellation_iterations(other);
+        merge_count_do_injury(other);
+        merge_count_do_fatality(other);
+        merge_count_do_scare(other);
+        merge_count_undo_injury(other);
+        merge_count_undo_fatality(other);
+        merge_count_undo_scare(other);
+        merge_time_max_interchange(other);
+        merge_time_min_interchange(other);
+        merge_time_min_slide(other);
+        merge_time_max_slide(other);
+        merge_time_cancellation(other);
+        merge_time_anticancellation(other);
+        merge_time_max_increase(other);
+        merge_time_max_decrease(other);
+        merge_time_anticancellation_dict(other);
+        merge_time_do_injury(other);
+        merge_time_do_fatality(other);
+        merge_time_do_scare(other);
+        merge_time_undo_injury(other);
+        merge_time_undo_fatality(other);
+        merge_time_undo_scare(other);
+        merge_time_load_stacks(other);
+        merge_time_cut_preprocess(other);
+        merge_time_cut_postprocess(other);
+        merge_time_glue_preprocess(other);
+        merge_time_glue_postprocess(other);
+        merge_time_construct(other);
+        merge_time_construct_prepare(other);
+        merge_time_construct_loop(other);
+        merge_time_construct_cleanup(other);
+    }
+};
 
+// Statistics are kept per thread, such that separate contexts can be used from separate threads.
+// A program that reports statistics sees those of the operations run by the reporting thread,
+// including those that worker threads forward to it with `thread_statistics::take`.
+extern constinit thread_local persistence_statistics persistence_stats;
+
+// Counting and timing can be compiled out, see `docs/instrumentation.md`:
+// `DISABLE_STAT_COUNTERS` turns the counting macros into no-ops,
+// `DISABLE_STAT_TIMERS` turns the timing macros into no-ops, so that no clock is read.
+// The statistics objects remain, so reporting them still works, but disabled statistics stay zero.
+#ifdef DISABLE_STAT_COUNTERS
+#define PERSISTENCE_STAT(name, sign) static_cast<void>(0)
+#define PERSISTENCE_STAT_DEC(name, sign) static_cast<void>(0)
+#else
 #define PERSISTENCE_STAT(name, sign) persistence_stats.increment_##name<sign>()
 #define PERSISTENCE_STAT_DEC(name, sign) persistence_stats.decrement_##name<sign>()
-
+#endif
+
+// Hardware events are read outside of the clock reads, so that reading them isn't timed.
+#ifdef USE_PERF_COUNTERS
+#define PERF_BEGIN(name) const auto perf_begin_v_##name = time_scale_v_##name != 0 ? thread_perf_counters().read() : perf_counts{};
+#define PERF_END(stats, name, sign) stats.perf_##name<sign>((thread_perf_counters().read() - perf_begin_v_##name) * time_scale_v_##name);
+#else
+#define PERF_BEGIN(name)
+#define PERF_END(stats, name, sign)
+#endif
+
+#ifdef DISABLE_STAT_TIMERS
+#define TIME_STAT(name, sign, val) static_cast<void>(0)
+#define TIME_BEGIN(name) TRACE_BEGIN(name) static_cast<void>(0)
+#define TIME_END(name, sign) TRACE_END(name) static_cast<void>(0)
+#else
 #define TIME_STAT(name, sign, val) persistence_stats.time_##name<sign>(val)
-#define TIME_BEGIN(name) const auto time_begin_v_##name = time::time_now()
-#define TIME_END(name, sign) const auto time_end_v_##name = time::time_now(); \
-                             TIME_STAT(name, sign, time::time_diff(time_begin_v_##name, time_end_v_##name))
+#define TIME_BEGIN(name) TRACE_BEGIN(name) \
+                         const auto time_scale_v_##name = time::sample(); \
+                         PERF_BEGIN(name) \
+                         const auto time_begin_v_##name = time_scale_v_##name != 0 ? time::time_now() : time::time_point_type{}
+#define TIME_END(name, sign) do { \
+                                 if (time_scale_v_##name != 0) { \
+                                     const auto time_end_v_##name = time::time_now(); \
+                                     TIME_STAT(name, sign, time::scale(time::time_diff(time_begin_v_##name, time_end_v_##name), \
+                                                                       time_scale_v_##name)); \
+                                     PERF_END(persistence_stats, name, sign) \
+                                 } \
+                                 TRACE_END(name) \
+                             } while (false)
+#endif
 
 class dictionary_statistics {
     DEF_TIME_VAR_AND_FUNC(contains);
@@ -320,19 +586,28 @@ public:
     template<typename duration = std::chrono::duration<long, std::nano>>
     void write_statistics(csv_writer& writer) const {
         writer << std::make_pair("time_contains",
-                                 std::chrono::duration_cast<duration>(TIME_VAR(contains)[detail::sign_to_index(1)]))
+                                 time::to_duration<duration>(TIME_VAR(contains)[detail::sign_to_index(1)]))
                << std::make_pair("time_insert",
-                                 std::chrono::duration_cast<duration>(TIME_VAR(insert)[detail::sign_to_index(1)]))
+                                 time::to_duration<duration>(TIME_VAR(insert)[detail::sign_to_index(1)]))
                << std::make_pair("time_erase",
-                                 std::chrono::duration_cast<duration>(TIME_VAR(erase)[detail::sign_to_index(1)]))
+                                 time::to_duration<duration>(TIME_VAR(erase)[detail::sign_to_index(1)]))
                << std::make_pair("time_next",
-                                 std::chrono::duration_cast<duration>(TIME_VAR(next)[detail::sign_to_index(1)]))
+                                 time::to_duration<duration>(TIME_VAR(next)[detail::sign_to_index(1)]))
                << std::make_pair("time_previous",
-                                 std::chrono::duration_cast<duration>(TIME_VAR(previous)[detail::sign_to_index(1)]))
+                                 time::to_duration<duration>(TIME_VAR(previous)[detail::sign_to_index(1)]))
                << std::make_pair("time_join",
-                                 std::chrono::duration_cast<duration>(TIME_VAR(join)[detail::sign_to_index(1)]))
+                                 time::to_duration<duration>(TIME_VAR(join)[detail::sign_to_index(1)]))
                << std::make_pair("time_cut",
-                                 std::chrono::duration_cast<duration>(TIME_VAR(cut)[detail::sign_to_index(1)]));
+                                 time::to_duration<duration>(TIME_VAR(cut)[detail::sign_to_index(1)]));
+#ifdef USE_PERF_COUNTERS
+        detail::write_perf_counts(writer, "contains", PERF_VAR(contains)[detail::sign_to_index(1)]);
+        detail::write_perf_counts(writer, "insert", PERF_VAR(insert)[detail::sign_to_index(1)]);
+        detail::write_perf_counts(writer, "erase", PERF_VAR(erase)[detail::sign_to_index(1)]);
+        detail::write_perf_counts(writer, "next", PERF_VAR(next)[detail::sign_to_index(1)]);
+        detail::write_perf_counts(writer, "previous", PERF_VAR(previous)[detail::sign_to_index(1)]);
+        detail::write_perf_counts(writer, "join", PERF_VAR(join)[detail::sign_to_index(1)]);
+        detail::write_perf_counts(writer, "cut", PERF_VAR(cut)[detail::sign_to_index(1)]);
+#endif
     }
 
     void reset() {
@@ -344,13 +619,183 @@ public:
         reset_time_join();
         reset_time_cut();
     }
+
+    // Add the statistics of `other`, e.g., of another thread, to these.
+    void merge(const dictionary_statistics &other) {
+        merge_time_contains(other);
+        merge_time_insert(other);
+        merge_time_erase(other);
+        merge_time_next(other);
+        merge_time_previous(other);
+        merge_time_join(other);
+        merge_time_cut(other);
+    }
 };
 
-extern dictionary_statistics dictionary_stats;
+extern constinit thread_local dictionary_statistics dictionary_stats;
 
+#ifdef DISABLE_STAT_TIMERS
+#define DICT_TIME_STAT(name, val)
+#define DICT_TIME_BEGIN(name)
+#define DICT_TIME_END(name)
+#else
 #define DICT_TIME_STAT(name, val) dictionary_stats.time_##name<1>(val);
-#define DICT_TIME_BEGIN(name) const auto time_begin_v_##name = time::time_now();
-#define DICT_TIME_END(name) const auto time_end_v_##name = time::time_now(); \
-                            DICT_TIME_STAT(name, time::time_diff(time_begin_v_##name, time_end_v_##name))
+#define DICT_TIME_BEGIN(name) const auto time_scale_v_##name = time::sample(); \
+                              PERF_BEGIN(name) \
+                              const auto time_begin_v_##name = time_scale_v_##name != 0 ? time::time_now() : time::time_point_type{};
+#define DICT_TIME_END(name) do { \
+                                if (time_scale_v_##name != 0) { \
+                                    const auto time_end_v_##name = time::time_now(); \
+                                    DICT_TIME_STAT(name, time::scale(time::time_diff(time_begin_v_##name, time_end_v_##name), \
+                                                                     time_scale_v_##name)) \
+                                    PERF_END(dictionary_stats, name, 1) \
+                                } \
+                            } while (false)
+#endif
+
+#define LATENCY_VAR(name) \
+    latency_##name
+
+#define DEF_LATENCY_VAR_AND_FUNC(name) \
+    public: latency_histogram& get_latency_##name() { return LATENCY_VAR(name); } \
+    private: latency_histogram LATENCY_VAR(name) = {}
+
+// Histograms of the latencies of the public operations of `persistence_context`,
+// from which percentiles of the latencies are reported.
+// Like the other statistics, latencies are kept per thread; `merge` combines those of several threads.
+class latency_statistics {
+    DEF_LATENCY_VAR_AND_FUNC(change_value);
+    DEF_LATENCY_VAR_AND_FUNC(insert);
+    DEF_LATENCY_VAR_AND_FUNC(delete);
+    DEF_LATENCY_VAR_AND_FUNC(cut);
+    DEF_LATENCY_VAR_AND_FUNC(glue);
+    DEF_LATENCY_VAR_AND_FUNC(construct);
+    DEF_LATENCY_VAR_AND_FUNC(diagram);
+
+public:
+    template<typename duration = std::chrono::duration<long, std::nano>>
+    void write_statistics(std::ostream &stream) const {
+        csv_writer writer;
+        write_statistics<duration>(writer);
+        writer.write_to_stream_and_reset(stream);
+    }
+    // Writes the number of timed operations and the 50th, 90th, 99th and 99.9th percentile and the maximum of their latencies,
+    // e.g., `latency_cut_count`, `latency_cut_p50`, ..., `latency_cut_p999`, `latency_cut_max`.
+    template<typename duration = std::chrono::duration<long, std::nano>>
+    void write_statistics(csv_writer &writer) const {
+        write_histogram<duration>(writer, "change_value", LATENCY_VAR(change_value));
+        write_histogram<duration>(writer, "insert", LATENCY_VAR(insert));
+        write_histogram<duration>(writer, "delete", LATENCY_VAR(delete));
+        write_histogram<duration>(writer, "cut", LATENCY_VAR(cut));
+        write_histogram<duration>(writer, "glue", LATENCY_VAR(glue));
+        write_histogram<duration>(writer, "construct", LATENCY_VAR(construct));
+        write_histogram<duration>(writer, "diagram", LATENCY_VAR(diagram));
+    }
+
+    void merge(const latency_statistics &other) {
+        LATENCY_VAR(change_value).merge(other.LATENCY_VAR(change_value));
+        LATENCY_VAR(insert).merge(other.LATENCY_VAR(insert));
+        LATENCY_VAR(delete).merge(other.LATENCY_VAR(delete));
+        LATENCY_VAR(cut).merge(other.LATENCY_VAR(cut));
+        LATENCY_VAR(glue).merge(other.LATENCY_VAR(glue));
+        LATENCY_VAR(construct).merge(other.LATENCY_VAR(construct));
+        LATENCY_VAR(diagram).merge(other.LATENCY_VAR(diagram));
+    }
+
+    void reset() {
+        LATENCY_VAR(change_value).reset();
+        LATENCY_VAR(insert).reset();
+        LATENCY_VAR(delete).reset();
+        LATENCY_VAR(cut).reset();
+        LATENCY_VAR(glue).reset();
+        LATENCY_VAR(construct).reset();
+        LATENCY_VAR(diagram).reset();
+    }
+
+private:
+    template<typename duration>
+    static void write_histogram(csv_writer &writer, const std::string &name, const latency_histogram &histogram) {
+        const auto to_duration = [](uint64_t value) {
+            return time::to_duration<duration>(time::from_count(static_cast<int64_t>(value)));
+        };
+        const auto prefix = "latency_" + name;
+        writer << std::make_pair((prefix + "_count").c_str(), histogram.get_count())
+               << std::make_pair((prefix + "_p50").c_str(), to_duration(histogram.value_at_percentile(50)))
+               << std::make_pair((prefix + "_p90").c_str(), to_duration(histogram.value_at_percentile(90)))
+               << std::make_pair((prefix + "_p99").c_str(), to_duration(histogram.value_at_percentile(99)))
+               << std::make_pair((prefix + "_p999").c_str(), to_duration(histogram.value_at_percentile(99.9)))
+               << std::make_pair((prefix + "_max").c_str(), to_duration(histogram.get_max()));
+    }
+};
+
+extern constinit thread_local latency_statistics latency_stats;
+
+// Whether the public operations record their latencies. Off by default,
+// since recording reads the clock twice per operation; shared by all threads.
+extern std::atomic<bool> latency_recording;
+
+inline void set_latency_recording(bool enable) {
+    latency_recording.store(enable, std::memory_order_relaxed);
+}
+
+inline bool get_latency_recording() {
+    return latency_recording.load(std::memory_order_relaxed);
+}
+
+// Records the time from its construction to its destruction in a latency histogram,
+// if latencies are recorded and the timer sampling doesn't skip it.
+class latency_scope {
+
+public:
+    explicit latency_scope(latency_histogram &histogram) :
+            histogram(histogram),
+            recorded(get_latency_recording() && time::sample() != 0),
+            begin(recorded ? time::time_now() : time::time_point_type{}) {}
+
+    ~latency_scope() {
+        if (recorded) {
+            histogram.record(static_cast<uint64_t>(time::to_count(time::time_diff(begin, time::time_now()))));
+        }
+    }
+
+    latency_scope(const latency_scope&) = delete;
+    latency_scope& operator=(const latency_scope&) = delete;
+
+private:
+    latency_histogram &histogram;
+    const bool recorded;
+    const time::time_point_type begin;
+
+};
+
+#ifdef DISABLE_STAT_TIMERS
+#define LATENCY_SCOPE(name) static_cast<void>(0)
+#else
+#define LATENCY_SCOPE(name) const latency_scope latency_scope_v_##name{latency_stats.get_latency_##name()}
+#endif
+
+// The statistics of one thread. Threads that work on behalf of another thread,
+// e.g., the workers of a context, hand their statistics to that thread with `take`,
+// such that they are reported like those of a single thread.
+struct thread_statistics {
+    persistence_statistics* persistence = nullptr;
+    dictionary_statistics* dictionary = nullptr;
+    latency_statistics* latency = nullptr;
+
+    static thread_statistics of_this_thread() {
+        return {&persistence_stats, &dictionary_stats, &latency_stats};
+    }
+
+    // Add the statistics of `other` to these and reset those of `other`.
+    // Neither thread may record statistics meanwhile.
+    void take(const thread_statistics &other) const {
+        persistence->merge(*other.persistence);
+        other.persistence->reset();
+        dictionary->merge(*other.dictionary);
+        other.dictionary->reset();
+        latency->merge(*other.latency);
+        other.latency->reset();
+    }
+};
 
 } // End of namespace bananas
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "utility/trace.h"
+
+using namespace bananas;
+
+namespace {
+
+// Buffers are taken once per thread, so the lock is not taken while recording.
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<trace_buffer>> registry;
+// Buffers of threads that have exited, whose events haven't been written or cleared yet
+std::vector<trace_buffer*> retired_buffers;
+// Empty buffers of threads that have exited, which new threads take before allocating a buffer
+std::vector<trace_buffer*> free_buffers;
+
+trace_buffer* take_buffer() {
+    std::lock_guard lock{registry_mutex};
+    if (!free_buffers.empty()) {
+        auto* buffer = free_buffers.back();
+        free_buffers.pop_back();
+        return buffer;
+    }
+    registry.push_back(std::make_unique<trace_buffer>(registry.size() + 1));
+    return registry.back().get();
+}
+
+void retire_buffer(trace_buffer* buffer) {
+    std::lock_guard lock{registry_mutex};
+    retired_buffers.push_back(buffer);
+}
+
+// Clears the buffers of exited threads and makes them available to new threads.
+// Expects `registry_mutex` to be held.
+void recycle_retired_buffers() {
+    for (auto* buffer: retired_buffers) {
+        buffer->clear();
+        free_buffers.push_back(buffer);
+    }
+    retired_buffers.clear();
+}
+
+// Takes a buffer for the thread that creates it and retires the buffer when the thread exits.
+class buffer_holder {
+
+public:
+    buffer_holder() : buffer(take_buffer()) {}
+
+    ~buffer_holder() {
+        retire_buffer(buffer);
+    }
+
+    buffer_holder(const buffer_holder&) = delete;
+    buffer_holder& operator=(const buffer_holder&) = delete;
+
+    trace_buffer* const buffer;
+
+};
+
+}
+
+trace_buffer& trace::thread_buffer() {
+    thread_local buffer_holder holder;
+    return *holder.buffer;
+}
+
+size_t trace::get_num_buffers() {
+    std::lock_guard lock{registry_mutex};
+    return registry.size();
+}
+
+void trace::write_chrome_trace(std::ostream &stream) {
+    std::lock_guard lock{registry_mutex};
+
+    // Timestamps are relative to the earliest recorded event.
+    auto origin = clock_type::time_point::max();
+    for (const auto &buffer: registry) {
+        buffer->for_each_event([&origin](const trace_event &event) {
+            origin = std::min(origin, event.begin);
+        });
+    }
+
+    using microseconds = std::chrono::duration<double, std::micro>;
+    const auto flags = stream.flags();
+    const auto precision = stream.precision();
+    stream << std::fixed << std::setprecision(3);
+    stream << "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto &buffer: registry) {
+        const auto thread_id = buffer->get_thread_id();
+        buffer->for_each_event([&](const trace_event &event) {
+            stream << (first ? "\n" : ",\n")
+                   << R"({"name":")" << event.name
+                   << R"(","cat":"bananas","ph":"X","pid":1,"tid":)" << thread_id
+                   << R"(,"ts":)" << microseconds(event.begin - origin).count()
+                   << R"(,"dur":)" << microseconds(event.end - event.begin).count() << "}";
+            first = false;
+        });
+    }
+    stream << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    stream.flags(flags);
+    stream.precision(precision);
+
+    recycle_retired_buffers();
+}
+
+void trace::clear() {
+    std::lock_guard lock{registry_mutex};
+    for (auto &buffer: registry) {
+        buffer->clear();
+    }
+    recycle_retired_buffers();
+}
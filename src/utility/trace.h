@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+
+namespace bananas {
+
+namespace trace {
+using clock_type = std::chrono::steady_clock;
+}
+
+// A recorded phase or operation: its name and the clock readings at its begin and end.
+struct trace_event {
+    const char* name = nullptr;
+    trace::clock_type::time_point begin{};
+    trace::clock_type::time_point end{};
+};
+
+// A ring buffer of the events recorded by one thread.
+// Only the owning thread records, without locking; once the buffer is full, the oldest events are overwritten.
+class trace_buffer {
+
+public:
+    constexpr static size_t capacity = size_t{1} << 16;
+
+    explicit trace_buffer(size_t thread_id) : thread_id(thread_id) {}
+
+    void record(const char* name, trace::clock_type::time_point begin, trace::clock_type::time_point end) {
+        const auto idx = num_recorded.load(std::memory_order_relaxed);
+        events[idx & (capacity - 1)] = {name, begin, end};
+        num_recorded.store(idx + 1, std::memory_order_release);
+    }
+
+    [[nodiscard]] size_t get_thread_id() const {
+        return thread_id;
+    }
+
+    // Calls `callback` on the events still in the buffer, from oldest to newest.
+    template<typename Callback>
+    void for_each_event(Callback &&callback) const {
+        const auto end = num_recorded.load(std::memory_order_acquire);
+        const auto begin = end > capacity ? end - capacity : 0;
+        for (auto idx = begin; idx < end; ++idx) {
+            callback(events[idx & (capacity - 1)]);
+        }
+    }
+
+    void clear() {
+        num_recorded.store(0, std::memory_order_release);
+    }
+
+private:
+    const size_t thread_id;
+    std::atomic<size_t> num_recorded{0};
+    std::array<trace_event, capacity> events;
+
+};
+
+namespace trace {
+
+// The buffer of the calling thread, taken on first use.
+// When the thread exits, its buffer keeps its events until the next `write_chrome_trace` or `clear`,
+// and is then reused by a thread started later, so the number of buffers is bounded by the most threads
+// that record between two calls of these functions.
+trace_buffer& thread_buffer();
+
+// Returns the number of buffers that have been allocated, each of which takes about 1.5MB.
+size_t get_num_buffers();
+
+inline void record(const char* name, clock_type::time_point begin, clock_type::time_point end) {
+    thread_buffer().record(name, begin, end);
+}
+
+// Write the events of all threads in the Chrome trace event format,
+// which can be viewed with Perfetto or `chrome://tracing`.
+// Threads that record while the trace is written may have their newest events torn or missing.
+void write_chrome_trace(std::ostream &stream);
+
+// Drop the events of all threads. Expects no thread to record concurrently.
+void clear();
+
+// Records the time from its construction to its destruction as an event.
+class scope {
+
+public:
+    explicit scope(const char* name) : name(name), begin(clock_type::now()) {}
+
+    ~scope() {
+        record(name, begin, clock_type::now());
+    }
+
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+
+private:
+    const char* const name;
+    const clock_type::time_point begin;
+
+};
+
+}
+
+}
+
+// Tracing is compiled in with `ENABLE_TRACING`, see `docs/instrumentation.md`.
+// `TRACE_SCOPE` traces the enclosing scope; `TRACE_BEGIN` and `TRACE_END` trace the phases marked by `TIME_BEGIN` and `TIME_END`.
+#ifdef ENABLE_TRACING
+#define TRACE_SCOPE(name) const bananas::trace::scope trace_scope_v{name}
+#define TRACE_BEGIN(name) const auto trace_begin_v_##name = bananas::trace::clock_type::now();
+#define TRACE_END(name) bananas::trace::record(#name, trace_begin_v_##name, bananas::trace::clock_type::now());
+#else
+#define TRACE_SCOPE(name) static_cast<void>(0)
+#define TRACE_BEGIN(name)
+#define TRACE_END(name)
+#endif
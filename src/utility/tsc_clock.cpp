@@ -0,0 +1,52 @@
+#include <chrono>
+#include <cpuid.h>
+#include <iostream>
+#include <thread>
+
+#include "utility/tsc_clock.h"
+
+using namespace bananas;
+
+namespace {
+
+double calibrate() {
+    constexpr auto calibration_time = std::chrono::milliseconds(2);
+    const auto begin_time = std::chrono::steady_clock::now();
+    const auto begin_ticks = tsc_clock::read_ticks();
+    std::this_thread::sleep_for(calibration_time);
+    const auto end_ticks = tsc_clock::read_ticks();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end_time - begin_time).count() /
+           static_cast<double>(end_ticks - begin_ticks);
+}
+
+// Calibrate during static initialization, such that converting ticks never waits for the calibration.
+[[maybe_unused]] const double startup_nanoseconds_per_tick = tsc_clock::nanoseconds_per_tick();
+
+#ifdef USE_TSC_CLOCK
+// The statistics timers read the time-stamp counter, so their times are wrong if it isn't invariant.
+[[maybe_unused]] const bool checked_invariant_tsc = []() {
+    if (!tsc_clock::has_invariant_tsc()) {
+        std::cerr << "Warning: The processor does not report an invariant time-stamp counter, "
+                  << "so the times of the statistics may be wrong.\n";
+    }
+    return true;
+}();
+#endif
+
+}
+
+double tsc_clock::nanoseconds_per_tick() {
+    // A function-local static, such that clocks used during static initialization of other files are calibrated, too.
+    static const double calibrated_nanoseconds_per_tick = calibrate();
+    return calibrated_nanoseconds_per_tick;
+}
+
+bool tsc_clock::has_invariant_tsc() {
+    unsigned int eax, ebx, ecx, edx;
+    // Advanced power management information, see the manuals of Intel and AMD
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0) {
+        return false;
+    }
+    return (edx & (1u << 8)) != 0;
+}
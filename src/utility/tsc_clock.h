@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if !defined(__x86_64__) && !defined(__i386__)
+#error "tsc_clock requires an x86 processor."
+#endif
+
+#include <x86intrin.h>
+
+namespace bananas {
+
+// A clock that reads the time-stamp counter of the processor,
+// which takes a few nanoseconds instead of the tens of nanoseconds of `std::chrono::high_resolution_clock`.
+// Expects an invariant TSC, i.e., one that ticks at a constant rate independent of frequency scaling
+// and is synchronized across cores; see `has_invariant_tsc`.
+//
+// Hot paths read and subtract raw ticks with `read_ticks` and `elapsed_ticks`.
+// Ticks are converted into durations with `to_duration`, using the length of a tick
+// that is calibrated against `std::chrono::steady_clock` during static initialization.
+// `now` makes the clock usable wherever a `std::chrono` clock is expected, e.g., by `Timer`.
+class tsc_clock {
+
+public:
+    using duration = std::chrono::nanoseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<tsc_clock>;
+    constexpr static bool is_steady = true;
+
+    using tick_point = uint64_t;
+    // A number of ticks. Not a `std::chrono::duration`, since the length of a tick is only known at runtime.
+    struct ticks {
+        int64_t count = 0;
+
+        constexpr ticks& operator+=(ticks other) {
+            count += other.count;
+            return *this;
+        }
+    };
+
+    static tick_point read_ticks() {
+        return __rdtsc();
+    }
+
+    static ticks elapsed_ticks(tick_point begin, tick_point end) {
+        return {static_cast<int64_t>(end - begin)};
+    }
+
+    template<typename out_duration = duration>
+    static out_duration to_duration(ticks t) {
+        return std::chrono::duration_cast<out_duration>(
+                std::chrono::duration<double, std::nano>(static_cast<double>(t.count) * nanoseconds_per_tick()));
+    }
+
+    static time_point now() {
+        return time_point(to_duration(ticks{static_cast<int64_t>(read_ticks())}));
+    }
+
+    // The length of a tick. The calibration sleeps for two milliseconds during static initialization
+    // and divides the time by the ticks that have passed.
+    static double nanoseconds_per_tick();
+
+    // Whether the processor reports an invariant TSC.
+    static bool has_invariant_tsc();
+
+};
+
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "datastructure/banana_tree.h"
+#include "datastructure/batch_construction.h"
+#include "datastructure/interval.h"
+#include "datastructure/list_item.h"
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
+#include "persistence_defs.h"
+#include "utility/random.h"
+#include "utility/stats.h"
+
+using namespace bananas;
+
+// Series of random lengths stored back to back, as expected by `construct_batch`.
+class BatchConstructionTest : public ::testing::Test {
+
+protected:
+    inline BatchConstructionTest() : rng(8812093) {}
+
+    void generate_series(size_t num_series, size_t min_length, size_t max_length) {
+        offsets.push_back(0);
+        for (size_t series = 0; series < num_series; ++series) {
+            const auto length = rng.next_int<size_t>(min_length, max_length);
+            for (size_t idx = 0; idx < length; ++idx) {
+                values.push_back(rng.next_real(-100.0, 100.0));
+            }
+            offsets.push_back(values.size());
+        }
+    }
+
+    // Store the series, which are expected to have the same length, interleaved.
+    std::vector<function_value_type> interleave() const {
+        const auto num_series = offsets.size() - 1;
+        std::vector<function_value_type> interleaved(values.size());
+        for (size_t series = 0; series < num_series; ++series) {
+            for (auto idx = offsets[series]; idx < offsets[series + 1]; ++idx) {
+                interleaved[(idx - offsets[series]) * num_series + series] = values[idx];
+            }
+        }
+        return interleaved;
+    }
+
+    // Compare the diagram of each series to that of an interval constructed on its own.
+    void expect_diagrams_match(const diagram_batch &diagrams) {
+        using persistence_diagram::diagram_type::essential;
+        using persistence_diagram::diagram_type::ordinary;
+        using persistence_diagram::diagram_type::relative;
+
+        ASSERT_EQ(diagrams.offsets.size(), offsets.size());
+        for (size_t series = 0; series + 1 < offsets.size(); ++series) {
+            const std::vector<function_value_type> series_values(values.begin() + offsets[series],
+                                                                 values.begin() + offsets[series + 1]);
+            if (series_values.size() < 2) {
+                EXPECT_EQ(diagrams.offsets[series], diagrams.offsets[series + 1]);
+                continue;
+            }
+            persistence_context reference_context;
+            std::vector<list_item*> items;
+            auto* reference_interval = reference_context.new_interval(series_values, {std::ref(items)});
+            auto* special_root = reference_interval->get_down_tree().get_special_root()->get_item();
+            persistence_diagram reference_diagram;
+            reference_context.compute_persistence_diagram(reference_diagram);
+
+            persistence_diagram batch_diagram;
+            for (auto idx = diagrams.offsets[series]; idx < diagrams.offsets[series + 1]; ++idx) {
+                const auto &pair = diagrams.pairs[idx];
+                ASSERT_LT(pair.birth, items.size());
+                ASSERT_TRUE(pair.death < items.size() || pair.death == indexed_persistent_pair::special_root);
+                auto* death = pair.death == indexed_persistent_pair::special_root ? special_root : items[pair.death];
+                switch (pair.type) {
+                case ordinary:
+                    batch_diagram.add_pair<ordinary>(items[pair.birth], death);
+                    break;
+                case essential:
+                    batch_diagram.add_pair<essential>(items[pair.birth], death);
+                    break;
+                case relative:
+                    batch_diagram.add_pair<relative>(items[pair.birth], death);
+                    break;
+                }
+            }
+            EXPECT_EQ(persistence_diagram::symmetric_difference(batch_diagram, reference_diagram).points, 0)
+                << "in series " << series;
+        }
+    }
+
+    std::vector<function_value_type> values;
+    std::vector<size_t> offsets;
+    random_number_generator<> rng;
+};
+
+TEST_F(BatchConstructionTest, MatchesSeparateConstruction) {
+    generate_series(300, 0, 200);
+    diagram_batch diagrams;
+    construct_batch({values, offsets}, diagrams, 4);
+    expect_diagrams_match(diagrams);
+}
+
+TEST_F(BatchConstructionTest, MatchesOnSingleThread) {
+    generate_series(40, 2, 50);
+    diagram_batch diagrams;
+    construct_batch({values, offsets}, diagrams, 1);
+    expect_diagrams_match(diagrams);
+}
+
+TEST_F(BatchConstructionTest, ReportsStatisticsOfAllThreads) {
+    generate_series(200, 2, 20);
+    latency_stats.reset();
+    set_latency_recording(true);
+    diagram_batch diagrams;
+    construct_batch({values, offsets}, diagrams, 4);
+    set_latency_recording(false);
+#ifndef DISABLE_STAT_TIMERS
+    // Each series is constructed once, on whichever thread takes its chunk.
+    EXPECT_EQ(latency_stats.get_latency_construct().get_count(), 200);
+#endif
+    latency_stats.reset();
+}
+
+TEST_F(BatchConstructionTest, HandlesEmptyBatch) {
+    offsets.push_back(0);
+    diagram_batch diagrams;
+    construct_batch({values, offsets}, diagrams);
+    EXPECT_TRUE(diagrams.pairs.empty());
+    EXPECT_EQ(diagrams.offsets.size(), 1);
+}
+
+TEST_F(BatchConstructionTest, MatchesSeparateConstructionInterleaved) {
+    generate_series(21, 150, 150);
+    const auto interleaved = interleave();
+    diagram_batch diagrams;
+    construct_diagrams_interleaved({interleaved, 21, 150}, diagrams, 2);
+    expect_diagrams_match(diagrams);
+}
+
+TEST_F(BatchConstructionTest, MatchesSeparateConstructionOfShortSeriesInterleaved) {
+    for (size_t length = 0; length < 5; ++length) {
+        values.clear();
+        offsets.clear();
+        generate_series(11, length, length);
+        const auto interleaved = interleave();
+        diagram_batch diagrams;
+        construct_diagrams_interleaved({interleaved, 11, length}, diagrams);
+        expect_diagrams_match(diagrams);
+    }
+}
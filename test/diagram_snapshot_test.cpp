@@ -0,0 +1,155 @@
+#include <atomic>
+#include <gtest/gtest.h>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "datastructure/diagram_snapshot.h"
+#include "datastructure/ingest_pipeline.h"
+#include "datastructure/interval.h"
+#include "datastructure/list_item.h"
+#include "datastructure/persistence_context.h"
+#include "persistence_defs.h"
+#include "utility/random.h"
+
+using namespace bananas;
+
+// Expect `snapshot` to contain the diagram of an interval constructed on `values`.
+void expect_snapshot_of(const diagram_snapshot &snapshot, const std::vector<function_value_type> &values) {
+    persistence_context reference_context;
+    auto* reference_interval = reference_context.new_interval(values);
+    const diagram_snapshot reference{*reference_interval, 0};
+    ASSERT_EQ(snapshot.get_pairs().size(), reference.get_pairs().size());
+    for (size_t idx = 0; idx < reference.get_pairs().size(); ++idx) {
+        const auto &pair = snapshot.get_pairs()[idx];
+        const auto &reference_pair = reference.get_pairs()[idx];
+        EXPECT_EQ(pair.birth_order, reference_pair.birth_order);
+        EXPECT_EQ(pair.birth_value, reference_pair.birth_value);
+        EXPECT_EQ(pair.death_order, reference_pair.death_order);
+        EXPECT_EQ(pair.death_value, reference_pair.death_value);
+        EXPECT_EQ(pair.type, reference_pair.type);
+    }
+}
+
+TEST(DiagramSnapshotTest, FindsPairsByBirth) {
+    persistence_context context;
+    auto* the_interval = context.new_interval({0, 5, 1, 4, 2, 3, -1, 6});
+    const diagram_snapshot snapshot{*the_interval, 7};
+    EXPECT_EQ(snapshot.get_epoch(), 7);
+    const auto pair = snapshot.find_pair(2);
+    ASSERT_TRUE(pair.has_value());
+    EXPECT_EQ(pair->death_order, 3);
+    EXPECT_EQ(pair->type, persistence_diagram::diagram_type::ordinary);
+    EXPECT_FALSE(snapshot.find_pair(2.5).has_value());
+}
+
+TEST(DiagramSnapshotTest, OutlivesInterval) {
+    persistence_context context;
+    const std::vector<function_value_type> values{0, 5, 1, 4, 2, 3, -1, 6};
+    auto* the_interval = context.new_interval(values);
+    snapshot_publisher publisher;
+    EXPECT_EQ(publisher.acquire(), nullptr);
+    publisher.publish(*the_interval);
+    auto snapshot = publisher.acquire();
+    context.delete_interval(the_interval);
+    expect_snapshot_of(*snapshot, values);
+}
+
+TEST(DiagramSnapshotTest, ReadsWhileWriterUpdates) {
+    constexpr size_t num_items = 200;
+    constexpr size_t num_batches = 200;
+    constexpr size_t batch_size = 10;
+    constexpr size_t num_readers = 4;
+
+    // The values of the interval after each batch
+    random_number_generator<> rng(7720913);
+    std::vector<std::vector<function_value_type>> history(1);
+    for (size_t idx = 0; idx < num_items; ++idx) {
+        history[0].push_back(rng.next_real(-100.0, 100.0));
+    }
+    std::vector<std::vector<std::pair<size_t, function_value_type>>> batches(num_batches);
+    for (auto &batch: batches) {
+        history.push_back(history.back());
+        for (size_t change = 0; change < batch_size; ++change) {
+            const auto idx = rng.next_int<size_t>(1, num_items - 2);
+            const auto value = rng.next_real(-100.0, 100.0);
+            batch.emplace_back(idx, value);
+            history.back()[idx] = value;
+        }
+    }
+
+    persistence_context context;
+    std::vector<list_item*> items;
+    auto* the_interval = context.new_interval(history[0], {std::ref(items)});
+    snapshot_publisher publisher;
+    publisher.publish(*the_interval);
+
+    std::atomic<bool> writing{true};
+    std::atomic<size_t> num_checked{0};
+    std::vector<std::thread> readers;
+    for (size_t reader = 0; reader < num_readers; ++reader) {
+        readers.emplace_back([&] {
+            uint64_t last_epoch = 0;
+            while (writing.load(std::memory_order_acquire)) {
+                auto snapshot = publisher.acquire();
+                EXPECT_GE(snapshot->get_epoch(), last_epoch);
+                if (snapshot->get_epoch() != last_epoch || num_checked == 0) {
+                    expect_snapshot_of(*snapshot, history[snapshot->get_epoch()]);
+                    ++num_checked;
+                }
+                last_epoch = snapshot->get_epoch();
+            }
+        });
+    }
+    for (const auto &batch: batches) {
+        for (const auto &[idx, value]: batch) {
+            context.change_value(the_interval, items[idx], value);
+        }
+        publisher.publish(*the_interval);
+    }
+    writing.store(false, std::memory_order_release);
+    for (auto &reader: readers) {
+        reader.join();
+    }
+    EXPECT_EQ(publisher.get_num_published(), num_batches + 1);
+    EXPECT_GT(num_checked, 0);
+    expect_snapshot_of(*publisher.acquire(), history.back());
+}
+
+TEST(DiagramSnapshotTest, PublishesDuringIngestion) {
+    std::stringstream stream;
+    stream << std::setprecision(17);
+    std::vector<function_value_type> values;
+    random_number_generator<> rng(1230987);
+    for (size_t idx = 0; idx < 1000; ++idx) {
+        values.push_back(rng.next_real(-100.0, 100.0));
+        stream << values.back() << " ";
+    }
+    persistence_context context;
+    snapshot_publisher publisher;
+    ingest_pipeline pipeline(context, {.chunk_size = 100, .max_chunks_in_flight = 2,
+                                       .publisher = &publisher, .chunks_per_snapshot = 1});
+    pipeline.ingest(stream);
+    EXPECT_EQ(publisher.get_num_published(), 10);
+    expect_snapshot_of(*publisher.acquire(), values);
+}
+
+TEST(DiagramSnapshotTest, PublishesEveryFewChunksAndAtTheEnd) {
+    std::stringstream stream;
+    stream << std::setprecision(17);
+    std::vector<function_value_type> values;
+    random_number_generator<> rng(5520931);
+    for (size_t idx = 0; idx < 1000; ++idx) {
+        values.push_back(rng.next_real(-100.0, 100.0));
+        stream << values.back() << " ";
+    }
+    persistence_context context;
+    snapshot_publisher publisher;
+    ingest_pipeline pipeline(context, {.chunk_size = 100, .max_chunks_in_flight = 2,
+                                       .publisher = &publisher, .chunks_per_snapshot = 3});
+    pipeline.ingest(stream);
+    // After chunks 3, 6 and 9, and after the last chunk.
+    EXPECT_EQ(publisher.get_num_published(), 4);
+    expect_snapshot_of(*publisher.acquire(), values);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#include "datastructure/ingest_pipeline.h"
+#include "datastructure/interval.h"
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
+#include "persistence_defs.h"
+#include "utility/random.h"
+#include "validation.h"
+
+using namespace bananas;
+
+// A random time series with repeated values, given as text,
+// together with the series without consecutive repetitions.
+class IngestPipelineTest : public ::testing::Test {
+
+protected:
+    inline IngestPipelineTest() : rng(4408817) {
+        stream << std::setprecision(17);
+    }
+
+    void generate_series(size_t num_values) {
+        for (size_t idx = 0; idx < num_values; ++idx) {
+            const auto value = rng.next_int<int>(0, 3) == 0 && !values.empty()
+                ? values.back()
+                : static_cast<function_value_type>(rng.next_int<int>(-100000, 100000)) / 16;
+            stream << value << (idx % 7 == 0 ? "\n" : " ");
+            if (values.empty() || value != values.back()) {
+                values.push_back(value);
+            }
+        }
+    }
+
+    // Compare the interval built by the pipeline to an interval constructed on all values at once.
+    void expect_matches_values(interval* ingested_interval, const persistence_context &context) {
+        ASSERT_NE(ingested_interval, nullptr);
+        expect_matches_reconstruction(context, ingested_interval, consecutive_orders(values.size()), values);
+    }
+
+    std::stringstream stream;
+    std::vector<function_value_type> values;
+    random_number_generator<> rng;
+};
+
+TEST_F(IngestPipelineTest, AppendsAllValues) {
+    generate_series(20000);
+    persistence_context context;
+    ingest_pipeline pipeline(context, {.chunk_size = 500, .max_chunks_in_flight = 4});
+    auto* ingested_interval = pipeline.ingest(stream);
+    expect_matches_values(ingested_interval, context);
+    EXPECT_EQ(pipeline.get_parser_statistics().num_values, values.size());
+    EXPECT_EQ(pipeline.get_maintenance_statistics().num_values, values.size());
+    EXPECT_EQ(pipeline.get_parser_statistics().num_chunks, pipeline.get_maintenance_statistics().num_chunks);
+}
+
+TEST_F(IngestPipelineTest, AppendsSingleValueChunks) {
+    generate_series(300);
+    persistence_context context;
+    ingest_pipeline pipeline(context, {.chunk_size = 1, .max_chunks_in_flight = 1});
+    auto* ingested_interval = pipeline.ingest(stream);
+    expect_matches_values(ingested_interval, context);
+}
+
+TEST_F(IngestPipelineTest, ContinuesAcrossStreams) {
+    generate_series(3000);
+    persistence_context context;
+    ingest_pipeline pipeline(context, {.chunk_size = 64, .max_chunks_in_flight = 8});
+    pipeline.ingest(stream);
+    stream.clear();
+    generate_series(3000);
+    auto* ingested_interval = pipeline.ingest(stream);
+    expect_matches_values(ingested_interval, context);
+}
+
+TEST_F(IngestPipelineTest, ReturnsNullForSingleValue) {
+    stream << "1.5 1.5";
+    persistence_context context;
+    ingest_pipeline pipeline(context);
+    EXPECT_EQ(pipeline.ingest(stream), nullptr);
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <sstream>
+
+#include "datastructure/persistence_context.h"
+#include "utility/latency_histogram.h"
+#include "utility/stats.h"
+
+using namespace bananas;
+
+TEST(LatencyHistogram, EmptyHistogram) {
+    latency_histogram histogram;
+    EXPECT_EQ(histogram.get_count(), 0);
+    EXPECT_EQ(histogram.get_max(), 0);
+    EXPECT_EQ(histogram.value_at_percentile(50), 0);
+}
+
+TEST(LatencyHistogram, SmallValuesAreExact) {
+    latency_histogram histogram;
+    for (uint64_t value = 1; value <= 10; ++value) {
+        histogram.record(value);
+    }
+    EXPECT_EQ(histogram.get_count(), 10);
+    EXPECT_EQ(histogram.value_at_percentile(50), 5);
+    EXPECT_EQ(histogram.value_at_percentile(90), 9);
+    EXPECT_EQ(histogram.value_at_percentile(100), 10);
+    EXPECT_EQ(histogram.get_max(), 10);
+}
+
+TEST(LatencyHistogram, PercentilesWithinResolution) {
+    latency_histogram histogram;
+    for (uint64_t value = 1; value <= 100000; ++value) {
+        histogram.record(value);
+    }
+    const double resolution = 1.0 / latency_histogram::sub_bucket_count;
+    for (double percentile: {50.0, 90.0, 99.0, 99.9}) {
+        const auto expected = static_cast<double>(percentile) * 1000;
+        const auto actual = static_cast<double>(histogram.value_at_percentile(percentile));
+        EXPECT_GE(actual, expected);
+        EXPECT_LE(actual, expected * (1 + resolution));
+    }
+    EXPECT_EQ(histogram.value_at_percentile(100), 100000);
+}
+
+TEST(LatencyHistogram, LargeValues) {
+    latency_histogram histogram;
+    histogram.record(std::numeric_limits<uint64_t>::max());
+    histogram.record(uint64_t{1} << 40);
+    EXPECT_EQ(histogram.value_at_percentile(50), uint64_t{1} << 40 | ((uint64_t{1} << 36) - 1));
+    EXPECT_EQ(histogram.value_at_percentile(100), std::numeric_limits<uint64_t>::max());
+}
+
+TEST(LatencyHistogram, Merge) {
+    latency_histogram low;
+    latency_histogram high;
+    for (uint64_t value = 0; value < 90; ++value) {
+        low.record(1);
+    }
+    for (uint64_t value = 0; value < 10; ++value) {
+        high.record(1000);
+    }
+    low.merge(high);
+    EXPECT_EQ(low.get_count(), 100);
+    EXPECT_EQ(low.get_max(), 1000);
+    EXPECT_EQ(low.value_at_percentile(90), 1);
+    EXPECT_GE(low.value_at_percentile(91), 1000);
+}
+
+#ifndef DISABLE_STAT_TIMERS
+TEST(LatencyStatistics, RecordsContextOperations) {
+    latency_stats.reset();
+    set_latency_recording(true);
+    persistence_context context;
+    auto* the_interval = context.new_interval({0.0, 3.0, 1.0, 4.0, 2.0, 5.0});
+    auto* item = context.insert_item(the_interval, 2.5, 10);
+    context.change_value(the_interval, item, -1);
+    context.delete_item(the_interval, item);
+    persistence_diagram diagram;
+    context.compute_persistence_diagram(diagram);
+
+    csv_writer writer;
+    latency_stats.write_statistics(writer);
+    std::stringstream stream;
+    writer.write_to_stream_and_reset(stream);
+    EXPECT_NE(stream.str().find("latency_change_value_p999"), std::string::npos);
+
+    EXPECT_EQ(latency_stats.get_latency_construct().get_count(), 1);
+    EXPECT_EQ(latency_stats.get_latency_insert().get_count(), 1);
+    EXPECT_EQ(latency_stats.get_latency_change_value().get_count(), 1);
+    EXPECT_EQ(latency_stats.get_latency_delete().get_count(), 1);
+    EXPECT_EQ(latency_stats.get_latency_diagram().get_count(), 1);
+    EXPECT_EQ(latency_stats.get_latency_cut().get_count(), 0);
+
+    latency_statistics merged;
+    merged.merge(latency_stats);
+    merged.merge(latency_stats);
+    EXPECT_EQ(merged.get_latency_construct().get_count(), 2);
+    set_latency_recording(false);
+    latency_stats.reset();
+}
+#endif
+
+TEST(LatencyStatistics, RecordsNothingByDefault) {
+    latency_stats.reset();
+    persistence_context context;
+    auto* the_interval = context.new_interval({0.0, 3.0, 1.0, 4.0, 2.0, 5.0});
+    context.change_value(the_interval, context.find_item(the_interval, 2), -1);
+    EXPECT_EQ(latency_stats.get_latency_construct().get_count(), 0);
+    EXPECT_EQ(latency_stats.get_latency_change_value().get_count(), 0);
+}
@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <utility>
 
 #include "datastructure/list_item.h"
 
@@ -138,3 +139,16 @@ TEST(ListItem, IdentifiesCriticality) {
     EXPECT_FALSE(item_d.is_critical<1>());
     EXPECT_FALSE(item_d.is_critical<-1>());
 }
+
+TEST(ListItem, KeepsOrderAndValueWhenMoved) {
+    auto item = list_item(3.0, 7.0);
+    auto moved_item = list_item(std::move(item));
+    EXPECT_EQ(moved_item.get_interval_order(), 3.0);
+    EXPECT_EQ(moved_item.value<1>(), 7.0);
+}
+
+TEST(ListItemDeathTest, RejectsMovingItemsWithHandles) {
+    auto item = list_item(5.0);
+    item.assign_handle_index(0);
+    EXPECT_DEATH(list_item{std::move(item)}, "Items with a handle must not be moved.");
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "datastructure/interval.h"
+#include "datastructure/list_item.h"
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
+#include "persistence_defs.h"
+#include "utility/memory_usage.h"
+#include "utility/random.h"
+#include "utility/recycling_object_pool.h"
+
+using namespace bananas;
+
+namespace {
+
+// The components that are accounted for both per interval and per context.
+void expect_equal_interval_components(const memory_usage &a, const memory_usage &b) {
+    EXPECT_EQ(a.num_items, b.num_items);
+    EXPECT_EQ(a.list_items, b.list_items);
+    EXPECT_EQ(a.dictionary_hooks, b.dictionary_hooks);
+    EXPECT_EQ(a.up_nodes, b.up_nodes);
+    EXPECT_EQ(a.down_nodes, b.down_nodes);
+}
+
+std::vector<function_value_type> random_values(size_t num_values) {
+    random_number_generator rng(4417);
+    std::vector<function_value_type> values;
+    for (size_t idx = 0; idx < num_values; ++idx) {
+        values.push_back(rng.next_real(-100.0, 100.0));
+    }
+    return values;
+}
+
+}
+
+TEST(RecyclingObjectPool, CountsLiveAndAllocatedObjects) {
+    recycling_object_pool<long> pool(4);
+    std::vector<long*> objects;
+    for (long idx = 0; idx < 10; ++idx) {
+        objects.push_back(pool.construct(idx));
+    }
+    EXPECT_EQ(pool.get_number_of_live_objects(), 10);
+    // Blocks of 4 and 8 objects.
+    EXPECT_EQ(pool.get_number_of_allocated_objects(), 12);
+    EXPECT_EQ(pool.get_allocated_bytes(), 12 * sizeof(long));
+
+    for (size_t idx = 0; idx < 6; ++idx) {
+        pool.free(objects[idx]);
+    }
+    pool.construct(42);
+    EXPECT_EQ(pool.get_number_of_live_objects(), 5);
+    EXPECT_EQ(pool.get_peak_number_of_live_objects(), 10);
+    EXPECT_EQ(pool.get_number_of_allocated_objects(), 12);
+}
+
+TEST(MemoryUsage, IntervalMatchesContext) {
+    persistence_context context;
+    const auto values = random_values(200);
+    std::vector<list_item*> items;
+    auto* ival = context.new_interval(values, {std::ref(items)});
+
+    auto interval_usage = context.get_memory_usage(ival);
+    const auto context_usage = context.get_memory_usage();
+    EXPECT_EQ(interval_usage.num_items, values.size());
+    expect_equal_interval_components(interval_usage, context_usage);
+    EXPECT_EQ(interval_usage.intervals, sizeof(interval));
+    EXPECT_GT(interval_usage.up_nodes, 0);
+    EXPECT_GT(interval_usage.down_nodes, 0);
+    EXPECT_GE(context_usage.total(), interval_usage.total());
+    EXPECT_GT(context_usage.bytes_per_item(), 0.0);
+
+    for (size_t idx = 1; idx < 60; ++idx) {
+        context.delete_item(ival, items[idx]);
+    }
+    interval_usage = context.get_memory_usage(ival);
+    EXPECT_EQ(interval_usage.num_items, values.size() - 59);
+    expect_equal_interval_components(interval_usage, context.get_memory_usage());
+}
+
+TEST(MemoryUsage, IntervalsAddUpToContext) {
+    persistence_context context;
+    const auto values = random_values(200);
+    std::vector<list_item*> items;
+    auto* ival = context.new_interval(values, {std::ref(items)});
+    const auto [left, right] = context.cut_interval(ival, items[80]);
+
+    auto sum = context.get_memory_usage(left);
+    sum += context.get_memory_usage(right);
+    // Cutting inserts a new endpoint into each of the two intervals.
+    EXPECT_EQ(sum.num_items, values.size() + 2);
+    expect_equal_interval_components(sum, context.get_memory_usage());
+    EXPECT_EQ(sum.intervals, 2 * sizeof(interval));
+}
+
+TEST(MemoryUsage, PeakIsKeptAfterDeletion) {
+    persistence_context context;
+    const auto values = random_values(100);
+    auto* ival = context.new_interval(values);
+    const auto peak_before = context.get_peak_memory_usage();
+    context.delete_interval(ival);
+
+    const auto live = context.get_memory_usage();
+    const auto peak = context.get_peak_memory_usage();
+    EXPECT_EQ(live.num_items, 0);
+    EXPECT_EQ(live.up_nodes, 0);
+    EXPECT_EQ(live.down_nodes, 0);
+    EXPECT_EQ(peak, peak_before);
+    EXPECT_GE(context.get_allocated_memory_bytes(), peak.list_items + peak.dictionary_hooks +
+                                                     peak.up_nodes + peak.down_nodes);
+}
+
+TEST(MemoryUsage, DiagramBytesGrowWithPairs) {
+    persistence_context context;
+    persistence_diagram empty_diagram;
+    persistence_diagram diagram;
+    context.compute_persistence_diagram(context.new_interval(random_values(100)), diagram);
+    EXPECT_GT(diagram.get_memory_bytes(), empty_diagram.get_memory_bytes());
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "datastructure/interval.h"
+#include "datastructure/list_item.h"
+#include "datastructure/multi_window_context.h"
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
+#include "persistence_defs.h"
+#include "utility/random.h"
+#include "validation.h"
+
+using namespace bananas;
+
+class MultiWindowTest : public ::testing::Test {
+
+protected:
+    inline MultiWindowTest() : windows({2, 5, 17, 40}), rng(2318420) {}
+
+    // Push a random walk of `num_values` values.
+    void push_random_walk(size_t num_values) {
+        for (size_t idx = 0; idx < num_values; ++idx) {
+            last_value += rng.next_real(-1.0, 1.0);
+            windows.push_value(last_value);
+        }
+    }
+
+    // Compare each window to an interval constructed from scratch on the window's values.
+    void expect_windows_match_reconstruction() {
+        std::vector<persistence_diagram> diagrams;
+        windows.compute_persistence_diagrams(diagrams);
+        ASSERT_EQ(diagrams.size(), windows.get_num_windows());
+        for (size_t idx = 0; idx < windows.get_num_windows(); ++idx) {
+            auto* window = windows.get_window(idx);
+            std::vector<function_value_type> values;
+            for (const list_item* item = window->get_left_endpoint(); item != nullptr; item = item->right_neighbor()) {
+                values.push_back(item->value<1>());
+            }
+            ASSERT_EQ(values.size(), windows.get_num_items(idx));
+            const auto first_order = window->get_left_endpoint()->get_interval_order();
+            EXPECT_EQ(first_order, static_cast<interval_order_type>(windows.get_num_samples() - values.size()));
+            expect_matches_reconstruction(*window, diagrams[idx], consecutive_orders(values.size(), first_order), values);
+        }
+    }
+
+    multi_window_context windows;
+    random_number_generator<> rng;
+    function_value_type last_value = 0;
+};
+
+TEST_F(MultiWindowTest, GrowsWindowsUntilFull) {
+    windows.push_value(0);
+    EXPECT_EQ(windows.get_window(0), nullptr);
+    push_random_walk(9);
+    EXPECT_EQ(windows.get_num_items(0), 2);
+    EXPECT_EQ(windows.get_num_items(1), 5);
+    EXPECT_EQ(windows.get_num_items(2), 10);
+    EXPECT_EQ(windows.get_num_items(3), 10);
+    expect_windows_match_reconstruction();
+}
+
+TEST_F(MultiWindowTest, SlidesAllWindows) {
+    for (size_t round = 0; round < 10; ++round) {
+        push_random_walk(13);
+        expect_windows_match_reconstruction();
+    }
+    EXPECT_EQ(windows.get_context().get_num_intervals(), windows.get_num_windows());
+    for (size_t idx = 0; idx < windows.get_num_windows(); ++idx) {
+        EXPECT_EQ(windows.get_num_items(idx), windows.get_window_size(idx));
+    }
+}
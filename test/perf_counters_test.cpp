@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include "utility/perf_counters.h"
+
+using namespace bananas;
+
+TEST(PerfCounters, ReadWithoutCounters) {
+    // Reading has to work whether or not the kernel lets us count events.
+    auto &counters = thread_perf_counters();
+    const auto counts = counters.read();
+    for (size_t idx = 0; idx < num_perf_events; ++idx) {
+        if (!counters.is_available(static_cast<perf_event>(idx))) {
+            EXPECT_EQ(counts.counts[idx], 0);
+        }
+    }
+}
+
+TEST(PerfCounters, CountsInstructions) {
+    auto &counters = thread_perf_counters();
+    if (!counters.is_available(perf_event::instructions)) {
+        GTEST_SKIP() << "Counting instructions is not permitted or not supported.";
+    }
+    const auto begin = counters.read();
+    volatile long sum = 0;
+    for (long i = 0; i < 100000; ++i) {
+        sum = sum + i;
+    }
+    const auto counts = counters.read() - begin;
+    EXPECT_GE(counts[perf_event::instructions], 100000);
+}
+
+TEST(PerfCounts, Arithmetic) {
+    perf_counts a;
+    a.counts = {1, 2, 3, 4, 5, 6};
+    perf_counts b = a * 2;
+    EXPECT_EQ(b[perf_event::branch_misses], 12);
+    b += a;
+    EXPECT_EQ(b[perf_event::cycles], 3);
+    EXPECT_EQ((b - a)[perf_event::llc_misses], 8);
+}
+
+TEST(PerfCounts, ScalesMultiplexedCounts) {
+    EXPECT_EQ(scale_multiplexed_count(1000, 500, 500), 1000);
+    EXPECT_EQ(scale_multiplexed_count(1000, 500, 250), 2000);
+    EXPECT_EQ(scale_multiplexed_count(1000, 500, 0), 0);
+}
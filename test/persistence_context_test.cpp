@@ -0,0 +1,546 @@
+#include <algorithm>
+#include <array>
+#include <gtest/gtest.h>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "datastructure/banana_tree.h"
+#include "datastructure/interchange_worker.h"
+#include "datastructure/interval.h"
+#include "datastructure/item_handle.h"
+#include "datastructure/list_item.h"
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
+#include "persistence_defs.h"
+#include "utility/random.h"
+#include "utility/stats.h"
+#include "validation.h"
+
+using namespace bananas;
+
+// An interval of random values at orders 0, 2, 4, ..., together with the orders and values
+// it is expected to represent after modifications.
+class ContextOperationTest : public ::testing::Test {
+
+protected:
+    explicit inline ContextOperationTest(size_t size = 60) : num_items(size), rng(8392011) {
+        for (size_t idx = 0; idx < num_items; ++idx) {
+            orders.push_back(2.0 * idx);
+            values.push_back(rng.next_real(-100.0, 100.0));
+        }
+        the_interval = the_context.new_interval(orders, values, {std::ref(items)});
+    }
+
+    // Compare `the_interval` to an interval constructed from scratch on `orders` and `values`.
+    void expect_matches_reconstruction() {
+        ::expect_matches_reconstruction(the_context, the_interval, orders, values);
+        EXPECT_TRUE(the_context.validate_num_items(the_interval));
+    }
+
+    // Record that an item with the given order and value is expected in the interval.
+    void expect_item(interval_order_type order, function_value_type value) {
+        auto it = std::ranges::lower_bound(orders, order);
+        auto idx = it - orders.begin();
+        if (it != orders.end() && *it == order) {
+            values[idx] = value;
+        } else {
+            orders.insert(it, order);
+            values.insert(values.begin() + idx, value);
+        }
+    }
+
+    // Record that all items with order less than `order` are expected to be deleted.
+    void expect_deleted_before(interval_order_type order) {
+        auto num_deleted = std::ranges::lower_bound(orders, order) - orders.begin();
+        orders.erase(orders.begin(), orders.begin() + num_deleted);
+        values.erase(values.begin(), values.begin() + num_deleted);
+    }
+
+    // Record that the items with index `first` to `last`, inclusive, in `orders` are expected to be deleted.
+    void expect_deleted_range(size_t first, size_t last) {
+        orders.erase(orders.begin() + first, orders.begin() + last + 1);
+        values.erase(values.begin() + first, values.begin() + last + 1);
+    }
+
+    const size_t num_items;
+    random_number_generator<> rng;
+    std::vector<interval_order_type> orders;
+    std::vector<function_value_type> values;
+    std::vector<list_item*> items;
+    persistence_context the_context;
+    interval* the_interval;
+};
+
+// Like `ContextOperationTest`, but with enough items for runs that are long enough to be processed by cuts.
+class LongRangeOperationTest : public ContextOperationTest {
+
+protected:
+    inline LongRangeOperationTest() : ContextOperationTest(600) {}
+};
+
+// Like `ContextOperationTest`, but the bananas of the interval are nested around its middle,
+// such that cutting there loads enough bananas onto the stacks for the trees to be cut in parallel.
+class NestedBananasOperationTest : public ContextOperationTest {
+
+protected:
+    inline NestedBananasOperationTest() : ContextOperationTest(1200) {
+        the_context.delete_interval(the_interval);
+        items.clear();
+        const size_t half = num_items / 2;
+        for (size_t idx = 0; idx < num_items; ++idx) {
+            const bool is_max = idx % 2 == 0;
+            const auto amplitude = static_cast<function_value_type>(idx < half ? (half - idx + 1) / 2 : (idx - half) / 2 + 1);
+            values[idx] = idx < half ? (is_max ? amplitude : -amplitude)
+                                     : (is_max ? amplitude - 0.1 : -amplitude - 0.1);
+        }
+        the_interval = the_context.new_interval(orders, values, {std::ref(items)});
+    }
+};
+
+// Like `ContextOperationTest`, but the interval consists of its two endpoints only.
+class TwoItemOperationTest : public ContextOperationTest {
+
+protected:
+    inline TwoItemOperationTest() : ContextOperationTest(2) {}
+};
+
+TEST_F(ContextOperationTest, FindsItemBefore) {
+    EXPECT_EQ(the_interval->item_before(0), nullptr);
+    EXPECT_EQ(the_interval->item_before(-1), nullptr);
+    EXPECT_EQ(the_interval->item_before(1), items[0]);
+    EXPECT_EQ(the_interval->item_before(2), items[0]);
+    EXPECT_EQ(the_interval->item_before(51), items[25]);
+    EXPECT_EQ(the_interval->item_before(1000), items[num_items - 1]);
+}
+
+TEST_F(ContextOperationTest, FindsItemByOrder) {
+    for (size_t idx = 0; idx < num_items; ++idx) {
+        EXPECT_EQ(the_context.find_item(the_interval, orders[idx]), items[idx]);
+    }
+    EXPECT_EQ(the_context.find_item(the_interval, -2), nullptr);
+    EXPECT_EQ(the_context.find_item(the_interval, 3), nullptr);
+    EXPECT_EQ(the_context.find_item(the_interval, 1000), nullptr);
+}
+
+TEST_F(ContextOperationTest, FindsNearestItem) {
+    EXPECT_EQ(the_context.find_nearest_item(the_interval, -5), items[0]);
+    EXPECT_EQ(the_context.find_nearest_item(the_interval, 0), items[0]);
+    EXPECT_EQ(the_context.find_nearest_item(the_interval, 2.9), items[1]);
+    EXPECT_EQ(the_context.find_nearest_item(the_interval, 3), items[1]);
+    EXPECT_EQ(the_context.find_nearest_item(the_interval, 3.1), items[2]);
+    EXPECT_EQ(the_context.find_nearest_item(the_interval, 1000), items[num_items - 1]);
+}
+
+TEST_F(ContextOperationTest, InsertsItemsByOrder) {
+    for (auto order: {31.0, 7.5, 118.5, 125.0, -3.0, 64.0, 0.0, 0.5}) {
+        auto value = rng.next_real(-100.0, 100.0);
+        auto* item = the_context.insert_item(the_interval, order, value);
+        EXPECT_EQ(item->get_interval_order(), order);
+        expect_item(order, value);
+    }
+    expect_matches_reconstruction();
+}
+
+TEST_F(ContextOperationTest, InsertsEndpointsAtExactOrder) {
+    // The last two orders are not recovered exactly when adding their difference to the previous endpoint,
+    // i.e., an order computed as endpoint plus offset would be rounded.
+    constexpr interval_order_type near_order = 118.03582355265098;
+    constexpr interval_order_type far_order = 187342.43629377856;
+    for (auto order: {near_order, -near_order, far_order, -far_order}) {
+        auto value = rng.next_real(-100.0, 100.0);
+        auto* item = the_context.insert_item(the_interval, order, value);
+        EXPECT_EQ(item->get_interval_order(), order);
+        expect_item(order, value);
+    }
+    EXPECT_EQ(the_interval->get_left_endpoint()->get_interval_order(), -far_order);
+    EXPECT_EQ(the_interval->get_right_endpoint()->get_interval_order(), far_order);
+    expect_matches_reconstruction();
+}
+
+TEST_F(TwoItemOperationTest, ChangesEndpointsPastEachOther) {
+    const auto usage_before = the_context.get_memory_usage();
+    for (size_t step = 0; step < 20; ++step) {
+        // Alternate between the endpoints and move the changed one past the other.
+        const size_t idx = step % 2;
+        const auto other_value = values[1 - idx];
+        const auto value = values[idx] < other_value ? rng.next_real(other_value, 100.0)
+                                                     : rng.next_real(-100.0, other_value);
+        the_context.change_value(the_interval, items[idx], value);
+        expect_item(orders[idx], value);
+        expect_matches_reconstruction();
+    }
+    // Constructing the trees anew reuses the nodes.
+    const auto usage_after = the_context.get_memory_usage();
+    EXPECT_EQ(usage_after.up_nodes, usage_before.up_nodes);
+    EXPECT_EQ(usage_after.down_nodes, usage_before.down_nodes);
+}
+
+TEST_F(ContextOperationTest, DeletesFewItemsBefore) {
+    the_interval = the_context.delete_items_before(the_interval, 5);
+    expect_deleted_before(5);
+    expect_matches_reconstruction();
+    EXPECT_EQ(the_context.get_num_intervals(), 1);
+}
+
+TEST_F(LongRangeOperationTest, DeletesManyItemsBeforeByCut) {
+    for (auto order: {101.0, 190.0, 395.5}) {
+        the_interval = the_context.delete_items_before(the_interval, order);
+        expect_deleted_before(order);
+        expect_matches_reconstruction();
+        EXPECT_EQ(the_context.get_num_intervals(), 1);
+    }
+}
+
+TEST_F(ContextOperationTest, DeletesShortRange) {
+    the_interval = the_context.delete_range(the_interval, items[20], items[23]);
+    expect_deleted_range(20, 23);
+    expect_matches_reconstruction();
+}
+
+TEST_F(LongRangeOperationTest, DeletesLongRangesByCuts) {
+    // Delete ranges from the back, so that indices in `items` and `orders` agree.
+    for (auto [first, last]: {std::pair{400, 570}, std::pair{210, 350}, std::pair{30, 200}}) {
+        the_interval = the_context.delete_range(the_interval, items[first], items[last]);
+        expect_deleted_range(first, last);
+        expect_matches_reconstruction();
+        EXPECT_EQ(the_context.get_num_intervals(), 1);
+    }
+}
+
+TEST_F(LongRangeOperationTest, DeletesRangesAtEnds) {
+    the_interval = the_context.delete_range(the_interval, items[450], items[num_items - 1]);
+    expect_deleted_range(450, num_items - 1);
+    expect_matches_reconstruction();
+    the_interval = the_context.delete_range(the_interval, items[0], items[200]);
+    expect_deleted_range(0, 200);
+    expect_matches_reconstruction();
+    EXPECT_EQ(the_context.get_num_intervals(), 1);
+}
+
+TEST_F(LongRangeOperationTest, DeletesRangeEndingBeforeLastItem) {
+    the_interval = the_context.delete_range(the_interval, items[300], items[num_items - 2]);
+    expect_deleted_range(300, num_items - 2);
+    expect_matches_reconstruction();
+    EXPECT_EQ(the_interval->get_right_endpoint(), items[num_items - 1]);
+    EXPECT_EQ(the_context.get_num_intervals(), 1);
+    // Only deleting by cuts creates further intervals.
+    EXPECT_GT(the_context.get_peak_memory_usage().intervals, sizeof(interval));
+}
+
+TEST_F(LongRangeOperationTest, InsertsRanges) {
+    // Insert a short and a long range in the middle, after the second to last item and at the right end.
+    for (auto [idx, num_values]: {std::pair<size_t, size_t>{10, 3}, {300, 250}, {num_items - 2, 120}, {num_items - 1, 200}}) {
+        std::vector<function_value_type> new_values;
+        for (size_t value_idx = 0; value_idx < num_values; ++value_idx) {
+            new_values.push_back(rng.next_real(-100.0, 100.0));
+        }
+        std::vector<list_item*> new_items;
+        the_interval = the_context.insert_range(the_interval, items[idx], new_values, std::ref(new_items));
+        ASSERT_EQ(new_items.size(), new_values.size());
+        for (size_t value_idx = 0; value_idx < new_values.size(); ++value_idx) {
+            EXPECT_GT(*new_items[value_idx], *items[idx]);
+            if (idx + 1 < num_items) {
+                EXPECT_LT(*new_items[value_idx], *items[idx + 1]);
+            }
+            expect_item(new_items[value_idx]->get_interval_order(), new_values[value_idx]);
+        }
+        expect_matches_reconstruction();
+        EXPECT_EQ(the_context.get_num_intervals(), 1);
+    }
+}
+
+TEST_F(ContextOperationTest, InsertsShortRangesIntoSameGap) {
+    // Each range goes between `items[10]` and the first item of the previous range.
+    for (size_t round = 0; round < 5; ++round) {
+        const std::vector<function_value_type> new_values{rng.next_real(-100.0, 100.0), rng.next_real(-100.0, 100.0)};
+        std::vector<list_item*> new_items;
+        the_interval = the_context.insert_range(the_interval, items[10], new_values, std::ref(new_items));
+        ASSERT_EQ(new_items.size(), new_values.size());
+        EXPECT_LT(*items[10], *new_items[0]);
+        EXPECT_LT(*new_items[0], *new_items[1]);
+        EXPECT_LT(*new_items[1], *items[10]->right_neighbor()->right_neighbor()->right_neighbor());
+        for (size_t value_idx = 0; value_idx < new_values.size(); ++value_idx) {
+            EXPECT_EQ(new_items[value_idx]->value<1>(), new_values[value_idx]);
+            expect_item(new_items[value_idx]->get_interval_order(), new_values[value_idx]);
+        }
+        expect_matches_reconstruction();
+    }
+}
+
+// Special roots move with their banana trees, which would leave the slot of a handle pointing to the old item.
+TEST(ContextOperationDeathTest, RejectsHandlesToSpecialRoots) {
+    persistence_context context;
+    auto* the_interval = context.new_interval({0.0, 1.0, 0.5});
+    auto* special_root = the_interval->get_up_tree().get_special_root()->get_item();
+    EXPECT_DEATH(context.get_handle(special_root), "Expected an item of an interval");
+}
+
+TEST(ContextOperationDeathTest, InsertingRangeIntoFullGapFails) {
+    // Doubles around 10^17 are 16 apart, so there is no order between the first two items.
+    persistence_context context;
+    std::vector<list_item*> items;
+    const std::vector<interval_order_type> orders{1e17, 1e17 + 16, 1e17 + 32};
+    const std::vector<function_value_type> values{0.0, 1.0, 0.5};
+    auto* the_interval = context.new_interval(orders, values, {std::ref(items)});
+    const std::vector<function_value_type> new_values{2.0, 3.0, 4.0};
+    EXPECT_DEATH(context.insert_range(the_interval, items[0], new_values),
+                 "Expected the orders of the new items to lie strictly between the orders of their neighbors.");
+}
+
+TEST_F(LongRangeOperationTest, ReplacesRanges) {
+    // Replace a short range, a long range in the middle, ranges at and next to the ends, and all items.
+    for (auto [first, last]: {std::pair<size_t, size_t>{5, 7}, {10, 300}, {0, 280}, {300, 598}, {320, 599}, {0, 599}}) {
+        std::vector<function_value_type> new_values;
+        for (size_t idx = first; idx <= last; ++idx) {
+            new_values.push_back(rng.next_real(-100.0, 100.0));
+        }
+        the_interval = the_context.replace_range(the_interval, items[first], items[last], new_values);
+        // The items of the range are kept.
+        for (size_t idx = first; idx <= last; ++idx) {
+            EXPECT_EQ(items[idx]->value<1>(), new_values[idx - first]);
+            EXPECT_EQ(items[idx]->get_interval_order(), 2.0 * idx);
+            expect_item(items[idx]->get_interval_order(), new_values[idx - first]);
+        }
+        expect_matches_reconstruction();
+        EXPECT_EQ(the_context.get_num_intervals(), 1);
+    }
+}
+
+TEST_F(ContextOperationTest, CutsRepeatedly) {
+    for (size_t cut_idx = 3; cut_idx + 3 < num_items; cut_idx += 4) {
+        auto [left, right] = the_context.cut_interval(the_interval, items[cut_idx]);
+        the_context.delete_interval(left);
+        the_interval = right;
+        // The right interval begins with an item inserted by the cut.
+        auto* right_of_cut = the_interval->get_left_endpoint();
+        expect_deleted_before(right_of_cut->get_interval_order());
+        expect_item(right_of_cut->get_interval_order(), right_of_cut->value<1>());
+        expect_matches_reconstruction();
+    }
+}
+
+TEST_F(ContextOperationTest, CutsRepeatedlyInParallel) {
+    the_context.set_parallel_cuts(true);
+    for (size_t cut_idx = 1; cut_idx + 3 < num_items; cut_idx += 3) {
+        auto [left, right] = the_context.cut_interval(the_interval, items[cut_idx]);
+        the_context.delete_interval(left);
+        the_interval = right;
+        auto* right_of_cut = the_interval->get_left_endpoint();
+        expect_deleted_before(right_of_cut->get_interval_order());
+        expect_item(right_of_cut->get_interval_order(), right_of_cut->value<1>());
+        expect_matches_reconstruction();
+    }
+}
+
+TEST_F(NestedBananasOperationTest, CutsInParallel) {
+    ASSERT_GE(num_items, persistence_scratch_space::min_bananas_for_parallel_cut);
+    the_context.set_parallel_cuts(true);
+    auto [left, right] = the_context.cut_interval(the_interval, items[num_items / 2 - 1]);
+    the_context.delete_interval(left);
+    the_interval = right;
+    auto* right_of_cut = the_interval->get_left_endpoint();
+    expect_deleted_before(right_of_cut->get_interval_order());
+    expect_item(right_of_cut->get_interval_order(), right_of_cut->value<1>());
+    expect_matches_reconstruction();
+}
+
+TEST_F(ContextOperationTest, CutsAtManyItems) {
+    // Cut items in arbitrary order and with a duplicate.
+    std::vector<size_t> cut_indices{50, 3, 20, 11, 20, 35, 27, 28};
+    std::vector<list_item*> cut_items;
+    for (auto idx: cut_indices) {
+        cut_items.push_back(items[idx]);
+    }
+    auto pieces = the_context.cut_interval_many(the_interval, cut_items);
+    std::ranges::sort(cut_indices);
+    auto duplicates = std::ranges::unique(cut_indices);
+    cut_indices.erase(duplicates.begin(), duplicates.end());
+    ASSERT_EQ(pieces.size(), cut_indices.size() + 1);
+    EXPECT_EQ(the_context.get_num_intervals(), pieces.size());
+
+    const auto all_orders = orders;
+    const auto all_values = values;
+    size_t first = 0;
+    for (size_t piece_idx = 0; piece_idx < pieces.size(); ++piece_idx) {
+        const size_t last = piece_idx < cut_indices.size() ? cut_indices[piece_idx] : num_items - 1;
+        the_interval = pieces[piece_idx];
+        orders.assign(all_orders.begin() + first, all_orders.begin() + last + 1);
+        values.assign(all_values.begin() + first, all_values.begin() + last + 1);
+        // Pieces begin and end with items inserted by the cuts, except at the ends of the original interval.
+        if (piece_idx > 0) {
+            auto* right_of_cut = the_interval->get_left_endpoint();
+            EXPECT_EQ(right_of_cut->right_neighbor(), items[first]);
+            expect_item(right_of_cut->get_interval_order(), right_of_cut->value<1>());
+        }
+        if (piece_idx + 1 < pieces.size()) {
+            auto* left_of_cut = the_interval->get_right_endpoint();
+            EXPECT_EQ(left_of_cut->left_neighbor(), items[last]);
+            expect_item(left_of_cut->get_interval_order(), left_of_cut->value<1>());
+        }
+        expect_matches_reconstruction();
+        first = last + 1;
+    }
+}
+
+TEST_F(ContextOperationTest, GluesManyIntervals) {
+    std::vector<list_item*> cut_items;
+    for (size_t idx = 4; idx + 3 < num_items; idx += 6) {
+        cut_items.push_back(items[idx]);
+    }
+    auto pieces = the_context.cut_interval_many(the_interval, cut_items);
+    // The items inserted by the cuts remain after gluing.
+    for (auto* piece: pieces) {
+        expect_item(piece->get_left_endpoint()->get_interval_order(), piece->get_left_endpoint()->value<1>());
+        expect_item(piece->get_right_endpoint()->get_interval_order(), piece->get_right_endpoint()->value<1>());
+    }
+    the_interval = the_context.glue_intervals_many(pieces);
+    EXPECT_EQ(the_context.get_num_intervals(), 1);
+    EXPECT_EQ(the_interval->get_left_endpoint(), items.front());
+    EXPECT_EQ(the_interval->get_right_endpoint(), items.back());
+    expect_matches_reconstruction();
+}
+
+TEST_F(ContextOperationTest, ResolvesHandles) {
+    std::vector<item_handle> handles;
+    for (auto* item: items) {
+        handles.push_back(the_context.get_handle(item));
+    }
+    EXPECT_EQ(the_context.get_handle(items[7]), handles[7]);
+    for (size_t idx = 0; idx < num_items; ++idx) {
+        EXPECT_EQ(the_context.resolve(handles[idx]), items[idx]);
+    }
+    EXPECT_EQ(the_context.resolve(item_handle{}), nullptr);
+}
+
+TEST_F(ContextOperationTest, InvalidatesHandlesOfDeletedItems) {
+    auto handle = the_context.get_handle(items[10]);
+    the_context.delete_item(the_interval, items[10]);
+    EXPECT_EQ(the_context.resolve(handle), nullptr);
+
+    // The new item may reuse the memory of the deleted item, but not its handle.
+    auto* new_item = the_context.insert_item(the_interval, 21.0, 5.0);
+    auto new_handle = the_context.get_handle(new_item);
+    EXPECT_EQ(the_context.resolve(handle), nullptr);
+    EXPECT_EQ(the_context.resolve(new_handle), new_item);
+
+    the_interval = the_context.delete_items_before(the_interval, 50.0);
+    EXPECT_EQ(the_context.resolve(new_handle), nullptr);
+}
+
+TEST_F(ContextOperationTest, CreatesIntervalWithHandles) {
+    std::vector<item_handle> handles;
+    auto* other_interval = the_context.new_interval(values, handles, 1000);
+    ASSERT_EQ(handles.size(), num_items);
+    for (size_t idx = 0; idx < num_items; ++idx) {
+        auto* item = the_context.resolve(handles[idx]);
+        ASSERT_NE(item, nullptr);
+        EXPECT_EQ(item->get_interval_order(), 1000 + idx);
+    }
+    the_context.delete_interval(other_interval);
+    for (auto handle: handles) {
+        EXPECT_EQ(the_context.resolve(handle), nullptr);
+    }
+}
+
+TEST_F(ContextOperationTest, ChangesValuesWithConcurrentInterchanges) {
+    // Maxima that grow to the right and minima that shrink to the right form deeply nested bananas,
+    // so moving an inner maximum or minimum outside of all bananas takes many interchanges.
+    the_context.delete_interval(the_interval);
+    orders.clear();
+    values.clear();
+    items.clear();
+    // Enough items for more interchanges than the worker takes at once.
+    for (size_t idx = 0; idx < 1200; ++idx) {
+        orders.push_back(static_cast<interval_order_type>(idx));
+        values.push_back(idx % 2 == 0 ? static_cast<function_value_type>(idx) : -static_cast<function_value_type>(idx));
+    }
+    the_interval = the_context.new_interval(orders, values, {std::ref(items)});
+
+    the_context.set_concurrent_interchanges(true);
+    for (auto [idx, value]: {std::pair<size_t, function_value_type>{2, 5000.0}, {3, -5000.0},
+                             {2, 2.5}, {3, -2.5}, {600, 6000.0}, {601, -6000.0}}) {
+        the_context.change_value(the_interval, items[idx], value);
+        expect_item(orders[idx], value);
+        expect_matches_reconstruction();
+    }
+    the_context.set_concurrent_interchanges(false);
+    the_context.change_value(the_interval, items[600], 600.5);
+    expect_item(orders[600], 600.5);
+    expect_matches_reconstruction();
+}
+
+TEST(ContextThreadingTest, ReportsInterchangesOfWorker) {
+    // Returns the number of interchanges of value changes that move a minimum and a maximum
+    // out of deeply nested bananas, as in `ChangesValuesWithConcurrentInterchanges`.
+    auto count_interchanges = [](bool concurrent) {
+        std::vector<function_value_type> values;
+        for (size_t idx = 0; idx < 1200; ++idx) {
+            values.push_back(idx % 2 == 0 ? static_cast<function_value_type>(idx) : -static_cast<function_value_type>(idx));
+        }
+        persistence_context context;
+        context.set_concurrent_interchanges(concurrent);
+        std::vector<list_item*> items;
+        auto* the_interval = context.new_interval(values, {std::ref(items)});
+        persistence_stats.reset();
+        context.change_value(the_interval, items[2], 5000.0);
+        context.change_value(the_interval, items[3], -5000.0);
+        return std::array{persistence_stats.get_count_min_interchange<1>(),
+                          persistence_stats.get_count_min_interchange<-1>(),
+                          persistence_stats.get_count_max_interchange<1>(),
+                          persistence_stats.get_count_max_interchange<-1>()};
+    };
+    const auto serial_counts = count_interchanges(false);
+    EXPECT_EQ(count_interchanges(true), serial_counts);
+#ifndef DISABLE_STAT_COUNTERS
+    EXPECT_GT(serial_counts[0] + serial_counts[1], static_cast<long>(2 * interchange_worker::batch_size));
+#endif
+}
+
+TEST(ContextThreadingTest, UsesContextsFromSeveralThreads) {
+    constexpr size_t num_threads = 4;
+    constexpr size_t num_items = 200;
+    // Each thread changes values of an interval in its own context and cuts the interval.
+    std::vector<std::vector<interval_order_type>> orders(num_threads);
+    std::vector<std::vector<function_value_type>> values(num_threads);
+    std::vector<persistence_context> contexts(num_threads);
+    std::vector<interval*> intervals(num_threads);
+
+    auto update = [&](size_t thread_idx) {
+        random_number_generator<> rng(4711 + thread_idx);
+        auto &context = contexts[thread_idx];
+        auto &thread_orders = orders[thread_idx];
+        auto &thread_values = values[thread_idx];
+        for (size_t idx = 0; idx < num_items; ++idx) {
+            thread_orders.push_back(static_cast<interval_order_type>(idx));
+            thread_values.push_back(rng.next_real(-100.0, 100.0));
+        }
+        std::vector<list_item*> items;
+        intervals[thread_idx] = context.new_interval(thread_orders, thread_values, {std::ref(items)});
+        for (size_t step = 0; step < 500; ++step) {
+            const auto idx = rng.next_int<size_t>(0, num_items - 1);
+            thread_values[idx] = rng.next_real(-100.0, 100.0);
+            context.change_value(intervals[thread_idx], items[idx], thread_values[idx]);
+        }
+        // Keep the items right of the cut, which starts with an item inserted by the cut.
+        auto [left, right] = context.cut_interval(intervals[thread_idx], items[num_items / 2]);
+        context.delete_interval(left);
+        intervals[thread_idx] = right;
+        thread_orders.erase(thread_orders.begin(), thread_orders.begin() + num_items / 2 + 1);
+        thread_values.erase(thread_values.begin(), thread_values.begin() + num_items / 2 + 1);
+        thread_orders.insert(thread_orders.begin(), right->get_left_endpoint()->get_interval_order());
+        thread_values.insert(thread_values.begin(), right->get_left_endpoint()->value<1>());
+    };
+    std::vector<std::thread> threads;
+    for (size_t thread_idx = 0; thread_idx < num_threads; ++thread_idx) {
+        threads.emplace_back(update, thread_idx);
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    for (size_t thread_idx = 0; thread_idx < num_threads; ++thread_idx) {
+        expect_matches_reconstruction(contexts[thread_idx], intervals[thread_idx],
+                                      orders[thread_idx], values[thread_idx]);
+    }
+}
@@ -150,3 +150,18 @@ TEST(SplayTree, SplitsCorrectlyLeft) {
     }
     EXPECT_GT(right_orders_sorted.back(), split_pos);
 }
+
+TEST(Dictionary, FindsNoPreviousItemBeforeFirstItem) {
+    auto items = init_item_vector({4, 8});
+    nc_dictionary dict(items.begin(), items.end());
+    EXPECT_TRUE(dict.previous_item(items[0]) == dict.end());
+    EXPECT_TRUE(dict.previous_item(list_item{2, 0}) == dict.end());
+    EXPECT_EQ(&*dict.previous_item(items[1]), &items[0]);
+    EXPECT_EQ(&*dict.previous_item(list_item{6, 0}), &items[0]);
+
+    // Decrementing `begin()` of a tree with a single item yields that item instead of `end()`.
+    auto single_item = init_item_vector({4});
+    nc_dictionary single_dict(single_item.begin(), single_item.end());
+    EXPECT_TRUE(single_dict.previous_item(single_item[0]) == single_dict.end());
+    EXPECT_TRUE(single_dict.previous_item(list_item{2, 0}) == single_dict.end());
+}
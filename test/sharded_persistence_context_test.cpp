@@ -0,0 +1,151 @@
+#include <array>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <utility>
+#include <vector>
+
+#include "datastructure/interval.h"
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
+#include "datastructure/sharded_persistence_context.h"
+#include "persistence_defs.h"
+#include "utility/random.h"
+#include "utility/stats.h"
+#include "validation.h"
+
+using namespace bananas;
+
+// Many series updated through a `sharded_persistence_context`, together with the values
+// each series is expected to have after the submitted operations.
+class ShardedContextTest : public ::testing::Test {
+
+protected:
+    constexpr static size_t num_series = 50;
+
+    inline ShardedContextTest() : sharded_context(3), values(num_series), rng(5537102) {}
+
+    // Query the series and compare it to an interval constructed from scratch
+    // on the values the series has at the time of submission.
+    void query_and_expect_match(size_t series) {
+        if (values[series].size() < sharded_persistence_context::min_interval_size) {
+            return;
+        }
+        ++num_expected_callbacks;
+        sharded_context.query(series, [this, expected_values = values[series]](interval &the_interval,
+                                                                               const persistence_diagram &diagram) {
+            expect_matches_reconstruction(the_interval, diagram,
+                                          consecutive_orders(expected_values.size()), expected_values);
+            ++num_callbacks;
+        });
+    }
+
+    sharded_persistence_context sharded_context;
+    std::vector<std::vector<function_value_type>> values;
+    random_number_generator<> rng;
+    size_t num_expected_callbacks = 0;
+    std::atomic<size_t> num_callbacks{0};
+};
+
+TEST_F(ShardedContextTest, AppliesMixedOperations) {
+    for (size_t step = 0; step < 5000; ++step) {
+        const auto series = rng.next_int<size_t>(0, num_series - 1);
+        const auto op = rng.next_int<int>(0, 9);
+        if (op < 6 || values[series].empty()) {
+            values[series].push_back(rng.next_real(-100.0, 100.0));
+            sharded_context.append(series, values[series].back());
+        } else if (op < 9) {
+            const auto sample_idx = rng.next_int<size_t>(0, values[series].size() - 1);
+            values[series][sample_idx] = rng.next_real(-100.0, 100.0);
+            sharded_context.change_value(series, sample_idx, values[series][sample_idx]);
+        } else {
+            query_and_expect_match(series);
+        }
+    }
+    for (size_t series = 0; series < num_series; ++series) {
+        query_and_expect_match(series);
+    }
+    sharded_context.flush();
+    EXPECT_EQ(num_callbacks, num_expected_callbacks);
+}
+
+TEST_F(ShardedContextTest, SkipsQueriesOfShortSeries) {
+    sharded_context.query(0, [this](interval&, const persistence_diagram&) { ++num_callbacks; });
+    sharded_context.append(1, 1.0);
+    sharded_context.query(1, [this](interval&, const persistence_diagram&) { ++num_callbacks; });
+    sharded_context.flush();
+    EXPECT_EQ(num_callbacks, 0);
+}
+
+TEST_F(ShardedContextTest, ChangesValuesOfTwoSampleSeries) {
+    values[0] = {1.0, 2.0};
+    sharded_context.append(0, values[0][0]);
+    sharded_context.append(0, values[0][1]);
+    for (auto [sample_idx, value]: {std::pair<size_t, function_value_type>{0, 3.0}, {1, 4.0}, {1, 0.5}, {0, -1.0}}) {
+        values[0][sample_idx] = value;
+        sharded_context.change_value(0, sample_idx, value);
+        query_and_expect_match(0);
+    }
+    sharded_context.flush();
+    EXPECT_EQ(num_callbacks, num_expected_callbacks);
+}
+
+TEST_F(ShardedContextTest, ReportsStatisticsOfWorkers) {
+    struct recorded_operation {
+        size_t series;
+        bool is_append;
+        size_t sample_idx;
+        function_value_type value;
+    };
+    std::vector<recorded_operation> operations;
+    persistence_stats.reset();
+    for (size_t step = 0; step < 2000; ++step) {
+        const auto series = rng.next_int<size_t>(0, num_series - 1);
+        if (values[series].size() < 4 || rng.next_int<int>(0, 1) == 0) {
+            values[series].push_back(rng.next_real(-100.0, 100.0));
+            operations.push_back({series, true, 0, values[series].back()});
+            sharded_context.append(series, values[series].back());
+        } else {
+            const auto sample_idx = rng.next_int<size_t>(0, values[series].size() - 1);
+            values[series][sample_idx] = rng.next_real(-100.0, 100.0);
+            operations.push_back({series, false, sample_idx, values[series][sample_idx]});
+            sharded_context.change_value(series, sample_idx, values[series][sample_idx]);
+        }
+    }
+    sharded_context.flush();
+    const std::array sharded_counts{persistence_stats.get_count_min_interchange<1>(),
+                                    persistence_stats.get_count_max_interchange<-1>(),
+                                    persistence_stats.get_count_cancellation<1>(),
+                                    persistence_stats.get_count_anticancellation<1>()};
+
+    // Apply the same operations in one context on this thread.
+    persistence_stats.reset();
+    persistence_context context;
+    std::vector<std::vector<function_value_type>> first_values(num_series);
+    std::vector<interval*> intervals(num_series, nullptr);
+    for (const auto &op: operations) {
+        if (intervals[op.series] == nullptr) {
+            if (op.is_append) {
+                first_values[op.series].push_back(op.value);
+            } else {
+                first_values[op.series][op.sample_idx] = op.value;
+            }
+            if (first_values[op.series].size() == sharded_persistence_context::min_interval_size) {
+                intervals[op.series] = context.new_interval(first_values[op.series]);
+            }
+        } else if (op.is_append) {
+            context.insert_right_endpoint(intervals[op.series], 1, op.value);
+        } else {
+            context.change_value(intervals[op.series],
+                                 context.find_item(intervals[op.series], static_cast<interval_order_type>(op.sample_idx)),
+                                 op.value);
+        }
+    }
+    const std::array serial_counts{persistence_stats.get_count_min_interchange<1>(),
+                                   persistence_stats.get_count_max_interchange<-1>(),
+                                   persistence_stats.get_count_cancellation<1>(),
+                                   persistence_stats.get_count_anticancellation<1>()};
+    EXPECT_EQ(sharded_counts, serial_counts);
+#ifndef DISABLE_STAT_COUNTERS
+    EXPECT_GT(serial_counts[0], 0);
+#endif
+}
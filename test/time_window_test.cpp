@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "datastructure/interval.h"
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
+#include "datastructure/time_window.h"
+#include "persistence_defs.h"
+#include "utility/random.h"
+#include "validation.h"
+
+using namespace bananas;
+
+class TimeWindowTest : public ::testing::Test {
+
+protected:
+    inline TimeWindowTest() : rng(1929381) {}
+
+    // Push samples at timestamps `0, 1, 2, ...`, where each sample arrives
+    // after at most `max_delay` samples with a larger timestamp.
+    void push_delayed_samples(size_t num_samples, size_t max_delay) {
+        // Samples by arrival time, which is the position in order plus a random delay.
+        std::multimap<size_t, std::pair<interval_order_type, function_value_type>> samples;
+        for (size_t idx = 0; idx < num_samples; ++idx) {
+            samples.emplace(idx + rng.next_int<size_t>(0, max_delay),
+                            std::make_pair(next_timestamp++, rng.next_real(-100.0, 100.0)));
+        }
+        for (auto [arrival, sample]: samples) {
+            auto [timestamp, value] = sample;
+            window.push_sample(timestamp, value);
+            expected_samples[timestamp] = value;
+        }
+    }
+
+    // Compare the window to an interval constructed from scratch on the samples within the horizon.
+    void expect_matches_reconstruction() {
+        std::vector<interval_order_type> orders;
+        std::vector<function_value_type> values;
+        auto newest = expected_samples.rbegin()->first;
+        for (auto [timestamp, value]: expected_samples) {
+            if (timestamp >= newest - window.get_horizon()) {
+                orders.push_back(timestamp);
+                values.push_back(value);
+            }
+        }
+
+        persistence_diagram diagram;
+        window.compute_persistence_diagram(diagram);
+        ::expect_matches_reconstruction(*window.get_interval(), diagram, orders, values);
+    }
+
+    random_number_generator<> rng;
+    time_window window{50, 4};
+    interval_order_type next_timestamp = 0;
+    std::map<interval_order_type, function_value_type> expected_samples;
+};
+
+TEST_F(TimeWindowTest, ReordersLateSamplesInBuffer) {
+    push_delayed_samples(200, 4);
+    window.flush();
+    EXPECT_EQ(window.get_num_buffered(), 0);
+    EXPECT_EQ(window.get_num_late_insertions(), 0);
+    EXPECT_EQ(window.get_num_dropped(), 0);
+    expect_matches_reconstruction();
+}
+
+TEST_F(TimeWindowTest, InsertsSamplesLaterThanBuffer) {
+    push_delayed_samples(200, 12);
+    window.flush();
+    EXPECT_GT(window.get_num_late_insertions(), 0);
+    expect_matches_reconstruction();
+}
+
+TEST_F(TimeWindowTest, EvictsAfterGap) {
+    push_delayed_samples(100, 2);
+    next_timestamp += 45;
+    push_delayed_samples(30, 2);
+    window.flush();
+    expect_matches_reconstruction();
+    EXPECT_EQ(window.get_context().get_num_intervals(), 1);
+}
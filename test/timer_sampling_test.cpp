@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "utility/stats.h"
+
+using namespace bananas;
+
+class TimerSampling : public ::testing::Test {
+protected:
+    void TearDown() override {
+        time::set_sampling_period(1);
+    }
+};
+
+TEST_F(TimerSampling, PeriodOneTimesEveryPhase) {
+    time::set_sampling_period(1);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(time::sample(), 1);
+    }
+}
+
+TEST_F(TimerSampling, SamplesOneInPeriod) {
+    constexpr long period = 16;
+    constexpr int num_draws = 160000;
+    time::set_sampling_period(period);
+    EXPECT_EQ(time::get_sampling_period(), period);
+
+    long num_sampled = 0;
+    for (int i = 0; i < num_draws; ++i) {
+        const auto factor = time::sample();
+        EXPECT_TRUE(factor == 0 || factor == period);
+        num_sampled += factor != 0;
+    }
+    EXPECT_NEAR(num_sampled, num_draws / period, 0.1 * num_draws / period);
+}
+
+TEST_F(TimerSampling, ScalesSampledTimes) {
+    using nanoseconds = std::chrono::duration<double, std::nano>;
+    const auto begin = time::time_now();
+    volatile long sum = 0;
+    for (long i = 0; i < 10000; ++i) {
+        sum = sum + i;
+    }
+    const auto elapsed = time::time_diff(begin, time::time_now());
+    EXPECT_DOUBLE_EQ(time::to_duration<nanoseconds>(time::scale(elapsed, 8)).count(),
+                     8 * time::to_duration<nanoseconds>(elapsed).count());
+}
+
+#ifndef DISABLE_STAT_TIMERS
+TEST_F(TimerSampling, ScalesTimesOfSampledPhases) {
+    constexpr long period = 8;
+    time::set_sampling_period(period);
+    // Returns the total time of the timed phases relative to the elapsed time.
+    auto time_phases = []() {
+        persistence_stats.reset();
+        const auto begin = time::time_now();
+        for (int phase = 0; phase < 4000; ++phase) {
+            TIME_BEGIN(construct);
+            volatile long sum = 0;
+            for (long i = 0; i < 2000; ++i) {
+                sum = sum + i;
+            }
+            TIME_END(construct, 1);
+        }
+        const auto elapsed = time::to_count(time::time_diff(begin, time::time_now()));
+        const auto total = time::to_count(persistence_stats.get_time_construct<1>());
+        // Each sampled phase is scaled by the period.
+        EXPECT_EQ(total % period, 0);
+        return static_cast<double>(total) / static_cast<double>(elapsed);
+    };
+    std::vector<double> ratios;
+    for (int run = 0; run < 7; ++run) {
+        ratios.push_back(time_phases());
+    }
+    persistence_stats.reset();
+    // The total estimates the time of all phases, which take most of the elapsed time.
+    // Without scaling, it would be about an eighth of it. A sampled phase that is preempted
+    // counts eight times, so the median of several runs is compared.
+    std::ranges::nth_element(ratios, ratios.begin() + 3);
+    EXPECT_GT(ratios[3], 0.5);
+    EXPECT_LT(ratios[3], 1.5);
+}
+#endif
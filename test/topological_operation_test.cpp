@@ -1,12 +1,18 @@
 #include "gtest/gtest.h"
+#include <array>
+#include <functional>
 #include <iostream>
 #include <limits>
+#include <vector>
 
 #include "datastructure/banana_tree.h"
 #include "datastructure/dictionary.h"
 #include "datastructure/interval.h"
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
 #include "example_trees/paper_tree.h"
 #include "persistence_defs.h"
+#include "utility/random.h"
 #include "utility/recycling_object_pool.h"
 #include "validation.h"
 
@@ -1448,3 +1454,108 @@ TEST_F(GlueIntervalsUpUp, LeftAboveRightThenCut) {
     validate_string_order(new_right_interval.get_down_tree(), right_crit_iter.begin(), right_crit_iter.end(), false);
     validate_spine_labels(new_right_interval.get_down_tree(), right_crit_iter.begin(), right_crit_iter.end());
 }
+
+TEST(BananaTreeSwapTest, SwapsGlobalMaxima) {
+    recycling_object_pool<up_tree_node> node_pool;
+    std::array<list_item, 3> left_items{list_item{0, 1}, list_item{1, 5}, list_item{2, 2}};
+    std::array<list_item, 3> right_items{list_item{3, 3}, list_item{4, 9}, list_item{5, 4}};
+    list_item::link(left_items[0], left_items[1]);
+    list_item::link(left_items[1], left_items[2]);
+    list_item::link(right_items[0], right_items[1]);
+    list_item::link(right_items[1], right_items[2]);
+    banana_tree<1> left_tree(node_pool, &left_items[0], &left_items[2]);
+    banana_tree<1> right_tree(node_pool, &right_items[0], &right_items[2]);
+    ASSERT_EQ(left_tree.get_global_max(), &left_items[1]);
+    ASSERT_EQ(right_tree.get_global_max(), &right_items[1]);
+
+    swap(left_tree, right_tree);
+    EXPECT_EQ(left_tree.get_global_max(), &right_items[1]);
+    EXPECT_EQ(right_tree.get_global_max(), &left_items[1]);
+}
+
+//
+// Regression tests for cutting intervals
+//
+
+// Validate the banana trees of `piece` and compare it to an interval constructed from scratch.
+void expect_valid_interval(persistence_context &context, interval* piece) {
+    std::vector<interval_order_type> piece_orders;
+    std::vector<function_value_type> piece_values;
+    for (auto &item: *piece) {
+        piece_orders.push_back(item.get_interval_order());
+        piece_values.push_back(item.value<1>());
+    }
+    expect_matches_reconstruction(context, piece, piece_orders, piece_values);
+
+    expect_both_spines(piece->get_up_tree().get_special_root());
+    expect_both_spines(piece->get_down_tree().get_special_root());
+    auto crit_iter = piece->critical_items();
+    validate_spine_labels(piece->get_up_tree(), crit_iter.begin(), crit_iter.end());
+    validate_spine_labels(piece->get_down_tree(), crit_iter.begin(), crit_iter.end());
+}
+
+// Cut an interval of the given `values` to the right of the item with index `cut_idx`,
+// validate the banana trees of both pieces and compare them to intervals constructed from scratch.
+void expect_valid_cut(const std::vector<function_value_type> &values, size_t cut_idx) {
+    persistence_context context;
+    std::vector<list_item*> items;
+    auto* the_interval = context.new_interval(values, {std::ref(items)});
+    auto [left, right] = context.cut_interval(the_interval, items[cut_idx]);
+    for (auto* piece: {left, right}) {
+        expect_valid_interval(context, piece);
+    }
+}
+
+// Bananas of one tree whose maximum is on the spine are held back while cutting the opposite tree.
+// Which bananas those are has to be decided before the up-tree is cut, since that relabels its spine.
+TEST(CutRegressionTest, HoldsBackSpineBananasDecidedBeforeCutting) {
+    expect_valid_cut({-88.964, 66.2656, -27.2526, 95.889, -82.0358, -20.6527, -29.1724, -2.6724, 98.1642, 61.6563}, 2);
+}
+
+// The special root may become the maximum of an injured or killed banana,
+// which must not move it off the spines; the special root of the cut-off tree is on both spines, too.
+TEST(CutRegressionTest, KeepsSpecialRootsOnBothSpines) {
+    expect_valid_cut({18.5689, 68.8531, 71.5891, 69.4503, 24.7127}, 1);
+}
+
+// Interchanges during the cut label the spine at the cut by the trails of the special root
+// before they are swapped, so the spine has to be relabelled afterwards.
+TEST(CutRegressionTest, RelabelsSpineAtCut) {
+    expect_valid_cut({-85.855, 67.9898, -75.7343, 13.8623, -12.5876, -96.2504, -91.8739, -50.4223}, 3);
+}
+
+// Gluing undoes the bananas above the glued endpoints, which labels their nodes by the spines
+// of the trees before gluing, so the spines of the glued trees have to be relabelled.
+TEST(GlueRegressionTest, RelabelsSpinesAfterGluing) {
+    persistence_context context;
+    std::vector<list_item*> items;
+    auto* the_interval = context.new_interval({18.5689, 68.8531, 71.5891, 69.4503, 24.7127}, {std::ref(items)});
+    auto [left, right] = context.cut_interval(the_interval, items[1]);
+    context.glue_intervals(left, right);
+    expect_valid_interval(context, left);
+}
+
+// Gluing relabels only the tops of the spines, down to the first node of the outer spines of the glued trees.
+// Glue random intervals of different sizes and scales, such that either tree may have the higher maximum
+// and the undone bananas may reach the special roots of both trees.
+TEST(GlueRegressionTest, RelabelsSpinesAfterGluingRandomIntervals) {
+    random_number_generator<> rng(4412087);
+    for (size_t round = 0; round < 200; ++round) {
+        const size_t num_left = rng.next_int<size_t>(2, 32);
+        const size_t num_right = rng.next_int<size_t>(2, 32);
+        const function_value_type right_scale = rng.next_real(0.25, 4.0);
+        std::vector<function_value_type> left_values;
+        std::vector<function_value_type> right_values;
+        for (size_t idx = 0; idx < num_left; ++idx) {
+            left_values.push_back(rng.next_real(-100.0, 100.0));
+        }
+        for (size_t idx = 0; idx < num_right; ++idx) {
+            right_values.push_back(right_scale * rng.next_real(-100.0, 100.0));
+        }
+        persistence_context context;
+        auto* left = context.new_interval(left_values);
+        auto* right = context.new_interval(right_values, std::nullopt, static_cast<interval_order_type>(num_left));
+        context.glue_intervals(left, right);
+        expect_valid_interval(context, left);
+    }
+}
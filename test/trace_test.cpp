@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "datastructure/persistence_context.h"
+#include "utility/trace.h"
+
+using namespace bananas;
+
+namespace {
+
+size_t count_occurrences(const std::string &text, const std::string &pattern) {
+    size_t count = 0;
+    for (auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+}
+
+TEST(Trace, WritesEventsOfAllThreads) {
+    trace::clear();
+    {
+        trace::scope outer{"outer"};
+        trace::scope inner{"inner"};
+    }
+    std::thread other([]() {
+        trace::scope scope{"other"};
+    });
+    other.join();
+
+    std::stringstream stream;
+    trace::write_chrome_trace(stream);
+    const auto json = stream.str();
+    EXPECT_EQ(json.rfind(R"({"traceEvents":[)", 0), 0);
+    EXPECT_EQ(count_occurrences(json, R"("name":"outer")"), 1);
+    EXPECT_EQ(count_occurrences(json, R"("name":"inner")"), 1);
+    EXPECT_EQ(count_occurrences(json, R"("name":"other")"), 1);
+    EXPECT_EQ(count_occurrences(json, R"("ph":"X")"), 3);
+
+    trace::clear();
+    std::stringstream empty_stream;
+    trace::write_chrome_trace(empty_stream);
+    EXPECT_EQ(count_occurrences(empty_stream.str(), R"("ph":"X")"), 0);
+}
+
+TEST(Trace, ReusesBuffersOfExitedThreads) {
+    trace::clear();
+    std::thread first([]() {
+        trace::scope scope{"first"};
+    });
+    first.join();
+    const auto num_buffers = trace::get_num_buffers();
+
+    // The events of an exited thread are kept until they are written.
+    std::thread second([]() {
+        trace::scope scope{"second"};
+    });
+    second.join();
+    std::stringstream stream;
+    trace::write_chrome_trace(stream);
+    EXPECT_EQ(count_occurrences(stream.str(), R"("name":"first")"), 1);
+    EXPECT_EQ(count_occurrences(stream.str(), R"("name":"second")"), 1);
+
+    for (size_t idx = 0; idx < 10; ++idx) {
+        std::thread other([]() {
+            trace::scope scope{"other"};
+        });
+        other.join();
+        trace::clear();
+    }
+    EXPECT_LE(trace::get_num_buffers(), num_buffers + 1);
+
+    std::stringstream empty_stream;
+    trace::write_chrome_trace(empty_stream);
+    EXPECT_EQ(count_occurrences(empty_stream.str(), R"("ph":"X")"), 0);
+}
+
+TEST(Trace, KeepsNewestEvents) {
+    trace_buffer buffer{1};
+    for (size_t idx = 0; idx < trace_buffer::capacity + 10; ++idx) {
+        const auto time = trace::clock_type::time_point{trace::clock_type::duration{idx}};
+        buffer.record("event", time, time);
+    }
+    size_t num_events = 0;
+    trace::clock_type::duration::rep first = -1;
+    buffer.for_each_event([&](const trace_event &event) {
+        if (num_events == 0) {
+            first = event.begin.time_since_epoch().count();
+        }
+        ++num_events;
+    });
+    EXPECT_EQ(num_events, trace_buffer::capacity);
+    EXPECT_EQ(first, 10);
+}
+
+#ifdef ENABLE_TRACING
+TEST(Trace, TracesContextOperations) {
+    trace::clear();
+    persistence_context context;
+    std::vector<list_item*> items;
+    auto* the_interval = context.new_interval({0.0, 3.0, 1.0, 4.0, 2.0, 5.0}, std::ref(items));
+    context.cut_interval(the_interval, items[2]);
+
+    std::stringstream stream;
+    trace::write_chrome_trace(stream);
+    const auto json = stream.str();
+    EXPECT_EQ(count_occurrences(json, R"("name":"new_interval")"), 1);
+    EXPECT_EQ(count_occurrences(json, R"("name":"cut_interval")"), 1);
+    EXPECT_GE(count_occurrences(json, R"("name":"construct")"), 2);
+    EXPECT_GE(count_occurrences(json, R"("name":"cut_preprocess")"), 1);
+    trace::clear();
+}
+#endif
@@ -0,0 +1,45 @@
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "utility/timer.h"
+#include "utility/tsc_clock.h"
+
+using namespace bananas;
+
+TEST(TscClock, IsMonotonic) {
+    auto previous = tsc_clock::read_ticks();
+    for (int i = 0; i < 1000; ++i) {
+        const auto current = tsc_clock::read_ticks();
+        EXPECT_GE(current, previous);
+        previous = current;
+    }
+}
+
+TEST(TscClock, AgreesWithSteadyClock) {
+    const auto steady_begin = std::chrono::steady_clock::now();
+    const auto tsc_begin = tsc_clock::read_ticks();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const auto tsc_end = tsc_clock::read_ticks();
+    const auto steady_end = std::chrono::steady_clock::now();
+
+    const auto steady_elapsed = std::chrono::duration<double, std::milli>(steady_end - steady_begin).count();
+    const auto tsc_elapsed = tsc_clock::to_duration<std::chrono::duration<double, std::milli>>(
+            tsc_clock::elapsed_ticks(tsc_begin, tsc_end)).count();
+    EXPECT_NEAR(tsc_elapsed, steady_elapsed, 0.05 * steady_elapsed);
+}
+
+TEST(TscClock, WorksWithTimer) {
+    Timer<std::chrono::milliseconds, tsc_clock> timer;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_GE(timer.elapsed().count(), 15);
+}
+
+TEST(TscClock, IsCalibratedAtStartup) {
+    const auto begin = std::chrono::steady_clock::now();
+    const auto nanoseconds_per_tick = tsc_clock::nanoseconds_per_tick();
+    const auto end = std::chrono::steady_clock::now();
+    EXPECT_GT(nanoseconds_per_tick, 0.0);
+    // The calibration would sleep for two milliseconds.
+    EXPECT_LT(end - begin, std::chrono::milliseconds(1));
+}
@@ -8,6 +8,9 @@
 #include <vector>
 
 #include "datastructure/banana_tree.h"
+#include "datastructure/interval.h"
+#include "datastructure/persistence_context.h"
+#include "datastructure/persistence_diagram.h"
 
 // Generic version; expects a `banana_tree_node*` Turn a node-pointer into a string.
 template<typename ptr_type>
@@ -233,3 +236,60 @@ void validate_spine_labels(tree_type &tree,
         }
     }
 }
+
+// Expect the intervals `a` and `b` to consist of items with the same orders and values,
+// and each item to be paired with items of the same order and value in their respective persistence diagrams.
+inline void expect_equal_persistence(bananas::interval &a,
+                                     const bananas::persistence_diagram &dgm_a,
+                                     bananas::interval &b,
+                                     const bananas::persistence_diagram &dgm_b) {
+    auto it_a = a.begin();
+    auto it_b = b.begin();
+    for (; it_a != a.end() && it_b != b.end(); ++it_a, ++it_b) {
+        ASSERT_EQ(it_a->get_interval_order(), it_b->get_interval_order());
+        ASSERT_EQ(it_a->value<1>(), it_b->value<1>());
+        auto* death_a = dgm_a.get_death(&(*it_a));
+        auto* death_b = dgm_b.get_death(&(*it_b));
+        ASSERT_EQ(death_a == nullptr, death_b == nullptr)
+            << "Only one of the items of order " << it_a->get_interval_order() << " is a birth";
+        if (death_a != nullptr) {
+            EXPECT_EQ(death_a->get_interval_order(), death_b->get_interval_order());
+            EXPECT_EQ(death_a->value<1>(), death_b->value<1>());
+        }
+    }
+    EXPECT_TRUE(it_a == a.end()) << "Interval `a` has more items than `b`";
+    EXPECT_TRUE(it_b == b.end()) << "Interval `b` has more items than `a`";
+}
+
+// Returns the orders `first_order`, `first_order + 1`, ... of `num_items` consecutive items,
+// which intervals constructed from values alone have.
+inline std::vector<interval_order_type> consecutive_orders(size_t num_items, interval_order_type first_order = 0) {
+    std::vector<interval_order_type> orders;
+    for (size_t idx = 0; idx < num_items; ++idx) {
+        orders.push_back(first_order + static_cast<interval_order_type>(idx));
+    }
+    return orders;
+}
+
+// Expect `the_interval` with persistence diagram `diagram` to match an interval constructed from scratch
+// on the given `orders` and `values`.
+inline void expect_matches_reconstruction(bananas::interval &the_interval,
+                                          const bananas::persistence_diagram &diagram,
+                                          const std::vector<interval_order_type> &orders,
+                                          const std::vector<function_value_type> &values) {
+    bananas::persistence_context reference_context;
+    auto* reference_interval = reference_context.new_interval(orders, values);
+    bananas::persistence_diagram reference_diagram;
+    reference_context.compute_persistence_diagram(reference_diagram);
+    expect_equal_persistence(the_interval, diagram, *reference_interval, reference_diagram);
+}
+
+// Like above, but computes the persistence diagram of `the_interval` in `context`.
+inline void expect_matches_reconstruction(const bananas::persistence_context &context,
+                                          bananas::interval* the_interval,
+                                          const std::vector<interval_order_type> &orders,
+                                          const std::vector<function_value_type> &values) {
+    bananas::persistence_diagram diagram;
+    context.compute_persistence_diagram(the_interval, diagram);
+    expect_matches_reconstruction(*the_interval, diagram, orders, values);
+}